@@ -0,0 +1,312 @@
+/** Sensor anomaly detection functions
+ * Every good sample of a channel updates, in constant time and memory, a
+ * Welford mean and variance of its values and of the changes between
+ * them, plus a window of the last ANOMWINDOW samples kept as integers so
+ * its running sums never accumulate rounding. From these a channel is
+ * flagged stuck when it has not moved for ANOMSTUCKTIME, changing too fast
+ * when one step exceeds its rate, noisy when the window's changes scatter
+ * far more than they have in the long run, and drifting when the window's
+ * mean has left the range learnt over the first ANOMBASELINE seconds.
+ * The baseline then keeps following the samples, slowly enough that a
+ * drift is flagged long before it is learnt, and is learnt afresh when
+ * the setpoints change. Spikes and noise are kept out of what is learnt.
+ * @version ghanomaly.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <math.h>
+#include "ghanomaly.h"
+
+static anomaly_s chans[ANOMCHANNELS];
+static int nchans;
+static long updates;
+static unsigned int held;       // kinds whose restored alarm awaits judgement, bit per kind
+static const char kindnames[ANOMKINDS][8] = {"stuck","rate","noise","drift"};
+static const char channames[SENSORS][12] = {"temperature","humidity","pressure"};
+static const anomcfg_s sensecfg[SENSORS] = {
+	{ 0.0, 0.5, 0.05, 1.0 },    // degrees C
+	{ 0.0, 2.0, 0.2, 5.0 },     // % relative humidity
+	{ 0.0, 0.5, 0.05, 25.0 },   // hPa, weather takes it far from the first day's mean
+};
+
+/** Starts a channel with no history
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param a channel
+ * @param cfg its thresholds
+ */
+void GhAnomalyInit(anomaly_s * a, anomcfg_s cfg) {
+	memset(a, 0, sizeof(anomaly_s));
+	a->cfg = cfg;
+}
+
+/** Adds a good sample to a channel and judges it
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param a channel
+ * @param value sample
+ * @param t time of the sample
+ * @return ANOMSTUCK, ANOMRATE, ANOMNOISE and ANOMDRIFT flags now set
+ */
+unsigned int GhAnomalyUpdate(anomaly_s * a, double value, time_t t) {
+	unsigned int flags = 0;
+	double q, d, delta, var, lsd, wmean, w;
+	int64_t v, old, next, prev, dsum;
+	time_t prevt = a->lastt;
+	int m;
+
+	// Rate and stuck need a previous sample
+	if (a->count > 0) {
+		d = value - a->last;
+		if (t > a->lastt && fabs(d) / (double)(t - a->lastt) > a->cfg.maxrate) {
+			flags |= ANOMRATE;
+			a->sincejump = 0;
+		}
+		if (fabs(value - a->stuckv) > a->cfg.stuckeps) {
+			a->stuckv = value;
+			a->moved = t;
+		}
+		else if (t - a->moved >= ANOMSTUCKTIME) {
+			flags |= ANOMSTUCK;
+		}
+		if (!(a->flags & (ANOMNOISE | ANOMRATE))) {
+			a->dn++;
+			delta = d - a->dmean;
+			a->dmean += delta / a->dn;
+			a->dm2 += delta * (d - a->dmean);
+		}
+	}
+	else {
+		a->first = a->base = a->moved = t;
+		a->stuckv = value;
+	}
+	a->last = value;
+	a->lastt = t;
+	a->sincejump += a->sincejump < ANOMWINDOW;
+
+	// Slide the window
+	q = value * ANOMSCALE;
+	v = (int64_t)(q < -ANOMLIMIT ? -ANOMLIMIT : (q > ANOMLIMIT ? ANOMLIMIT : llround(q)));
+	if (a->count == ANOMWINDOW) {
+		old = a->ring[a->pos];
+		next = a->ring[(a->pos + 1) % ANOMWINDOW];
+		a->sum -= old;
+		a->sumsq -= old * old;
+		a->dsumsq -= (next - old) * (next - old);
+		a->count--;
+	}
+	if (a->count > 0) {
+		prev = a->ring[(a->pos + ANOMWINDOW - 1) % ANOMWINDOW];
+		a->dsumsq += (v - prev) * (v - prev);
+	}
+	a->ring[a->pos] = (int32_t) v;
+	a->pos = (a->pos + 1) % ANOMWINDOW;
+	a->count++;
+	a->sum += v;
+	a->sumsq += v * v;
+
+	if (a->count == ANOMWINDOW) {
+		// Changes within the window, their sum telescopes to newest - oldest
+		m = ANOMWINDOW - 1;
+		dsum = v - a->ring[a->pos];
+		var = ((double) a->dsumsq - (double) dsum * dsum / m) / (m - 1);
+		var = var > 0.0 ? sqrt(var) / ANOMSCALE : 0.0;
+		lsd = a->dn > 1 ? sqrt(a->dm2 / (a->dn - 1)) : 0.0;
+		// A single jump in the window is a rate anomaly, not noise
+		if (a->dn >= ANOMWARMUP && a->sincejump >= ANOMWINDOW
+				&& var > a->cfg.noisefloor && var > ANOMNOISEK * lsd) {
+			flags |= ANOMNOISE;
+		}
+		wmean = a->sum / (double) ANOMWINDOW / ANOMSCALE;
+		if (a->basesd > 0.0 && fabs(wmean - a->mean) > a->cfg.driftfloor
+				&& fabs(wmean - a->mean) > ANOMDRIFTK * a->basesd) {
+			flags |= ANOMDRIFT;
+		}
+	}
+	// Every sample of the baseline is learnt. Afterwards its spread is kept,
+	// so a drift cannot widen the range it is judged against, and the mean
+	// decays towards the samples with a time constant of ANOMRELEARN, so a
+	// lasting change is learnt within days while a faster drift still
+	// leaves it behind
+	if (a->basesd == 0.0) {
+		a->n++;
+		delta = value - a->mean;
+		a->mean += delta / a->n;
+		a->m2 += delta * (value - a->mean);
+		if (t - a->base >= ANOMBASELINE && a->n > 1) {
+			a->basesd = sqrt(a->m2 / (a->n - 1));
+		}
+	}
+	else if (!(flags & (ANOMRATE | ANOMNOISE)) && t > prevt) {
+		w = (double)(t - prevt) / ANOMRELEARN;
+		a->mean += (w < 1.0 ? w : 1.0) * (value - a->mean);
+	}
+	for (int k = 0; k < ANOMKINDS; k++) {
+		if ((flags & ~a->flags) & (1u << k)) {
+			a->raised[k]++;
+		}
+	}
+	a->flags = flags;
+	return flags;
+}
+
+/** Tells whether every sampled channel has seen enough to judge a kind
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param k kind, 0 to ANOMKINDS - 1 in the order of the flags
+ * @param now time of the tick
+ * @return 1 if at least one channel is sampled and all of them can judge it
+ */
+static int GhAnomalyJudged(int k, time_t now) {
+	const anomaly_s * a;
+	int judged = 0;
+
+	for (int c = 0; c < nchans; c++) {
+		a = &chans[c];
+		if (a->count == 0) {
+			continue;
+		}
+		if ((k == 0 && now - a->first < ANOMSTUCKTIME)
+				|| (k == 1 && a->count < 2)
+				|| (k == 2 && (a->dn < ANOMWARMUP || a->count < ANOMWINDOW))
+				|| (k == 3 && a->basesd == 0.0)) {
+			return 0;
+		}
+		judged = 1;
+	}
+	return judged;
+}
+
+/** Gets the thresholds for a probe by what it measures
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static anomcfg_s GhAnomalyConfig(const char * kind) {
+	for (int i = 0; i < SENSORS; i++) {
+		if (strcmp(kind, channames[i]) == 0) {
+			return sensecfg[i];
+		}
+	}
+	return sensecfg[TEMPERATURE];
+}
+
+/** Feeds the good readings taken this tick and every new probe result to
+ * their channels, and raises SSTUCK, SRATE, SNOISE and SDRIFT while any
+ * channel is flagged.
+ * The value of each alarm is the first flagged channel: 0 to 2 for the
+ * Sense HAT sensors, 3 onwards for the registered probes. The detectors
+ * start afresh, so an alarm already in the list on the first call, one
+ * restored from a checkpoint, is left as it is until the channels have
+ * seen enough to judge its kind again.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param head alarm list
+ * @param rdata readings of this tick
+ * @param mask bit TEMPERATURE, HUMIDITY or PRESSURE set for each sensor
+ * read this tick, the others only repeat their last value
+ * @return alarm list
+ */
+alarm_s * GhAnomalyAlarms(alarm_s * head, reading_s rdata, unsigned int mask) {
+	const double values[SENSORS] = { rdata.temperature, rdata.humidity, rdata.pressure };
+	int first[ANOMKINDS] = { -1, -1, -1, -1 };
+	sensor_s s;
+	anomaly_s * a;
+
+	if (nchans == 0) {
+		for (int i = 0; i < SENSORS; i++) {
+			GhAnomalyInit(&chans[i], sensecfg[i]);
+		}
+		nchans = SENSORS;
+		for (int k = 0; k < ANOMKINDS; k++) {
+			if (GhFindAlarm(head, (alarm_e)(SSTUCK + k)) != NULL) {
+				held |= 1u << k;
+			}
+		}
+	}
+	for (int i = 0; i < SENSORS; i++) {
+		if ((mask & (1u << i)) && rdata.quality[i] == QGOOD) {
+			GhAnomalyUpdate(&chans[i], values[i], rdata.rtime);
+			updates++;
+		}
+	}
+	for (int p = 0; p < GhSensorCount() && SENSORS + p < ANOMCHANNELS; p++) {
+		s = GhSensorGet(p, rdata.rtime);
+		a = &chans[SENSORS + p];
+		if (SENSORS + p == nchans) {
+			GhAnomalyInit(a, GhAnomalyConfig(s.kind));
+			nchans++;
+		}
+		// A probe converts on its own cycle, take each result once
+		if (s.quality == QGOOD && (a->count == 0 || s.rtime != a->lastt)) {
+			GhAnomalyUpdate(a, s.value, s.rtime);
+			updates++;
+		}
+	}
+	for (int c = 0; c < nchans; c++) {
+		for (int k = 0; k < ANOMKINDS; k++) {
+			if ((chans[c].flags & (1u << k)) && first[k] < 0) {
+				first[k] = c;
+			}
+		}
+	}
+	for (int k = 0; k < ANOMKINDS; k++) {
+		if (first[k] >= 0) {
+			GhSetOneAlarm((alarm_e)(SSTUCK + k), rdata.rtime, first[k], head);
+			held &= ~(1u << k);
+		}
+		else if (!(held & (1u << k)) || GhAnomalyJudged(k, rdata.rtime)) {
+			head = GhClearOneAlarm((alarm_e)(SSTUCK + k), head);
+			held &= ~(1u << k);
+		}
+	}
+	return head;
+}
+
+/** Starts the baseline of every channel again, for when new setpoints move
+ * where the channels should settle. Drift is not judged until the new
+ * baseline has been learnt over ANOMBASELINE.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param t time of the change
+ */
+void GhAnomalyRebase(time_t t) {
+	for (int c = 0; c < nchans; c++) {
+		chans[c].n = 0;
+		chans[c].mean = 0.0;
+		chans[c].m2 = 0.0;
+		chans[c].basesd = 0.0;
+		chans[c].base = t;
+	}
+}
+
+/** Prints the long run statistics of every channel that was ever flagged
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ */
+void GhAnomalyReport(FILE * fp) {
+	const anomaly_s * a;
+	long raised = 0;
+
+	for (int c = 0; c < nchans; c++) {
+		for (int k = 0; k < ANOMKINDS; k++) {
+			raised += chans[c].raised[k];
+		}
+	}
+	if (nchans == 0) {
+		return;
+	}
+	fprintf(fp, "Anomalies: %d channels, %ld samples, %ld flagged\n", nchans, updates, raised);
+	for (int c = 0; c < nchans; c++) {
+		a = &chans[c];
+		if (a->raised[0] + a->raised[1] + a->raised[2] + a->raised[3] == 0) {
+			continue;
+		}
+		fprintf(fp, "  %-3d %-11s mean %8.2lf sd %6.2lf step sd %6.3lf",
+			c, c < SENSORS ? channames[c] : "probe", a->mean,
+			a->basesd > 0.0 ? a->basesd : (a->n > 1 ? sqrt(a->m2 / (a->n - 1)) : 0.0), a->dn > 1 ? sqrt(a->dm2 / (a->dn - 1)) : 0.0);
+		for (int k = 0; k < ANOMKINDS; k++) {
+			fprintf(fp, " %s %ld", kindnames[k], a->raised[k]);
+		}
+		fprintf(fp, "\n");
+	}
+}
@@ -0,0 +1,71 @@
+/** Sensor anomaly detection constants, structures, function prototypes
+ * @version ghanomaly.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHANOMALY_H
+#define GHANOMALY_H
+
+#include <stdint.h>
+#include "ghcontrol.h"
+#include "ghsensor.h"
+
+// Constants ##############################################
+#define ANOMWINDOW 64           // samples in the rolling window
+#define ANOMSCALE 1000.0        // window values are kept in thousandths
+#define ANOMLIMIT 10000000      // largest window value, keeps the sums of squares in range
+#define ANOMWARMUP 256          // changes seen before noise is judged
+#define ANOMBASELINE 86400      // seconds of history before drift is judged
+#define ANOMRELEARN 604800      // seconds, time constant the baseline follows the samples with after that
+#define ANOMSTUCKTIME 3600      // seconds without movement that make a sensor stuck
+#define ANOMNOISEK 5.0          // window sd of changes against the long run sd
+#define ANOMDRIFTK 4.0          // window mean from the long run mean, in long run sds
+#define ANOMCHANNELS (SENSORS + SENSORMAX)
+#define ANOMKINDS 4
+#define ANOMSTUCK 0x01          // flags, in the order of the SSTUCK.. alarm codes
+#define ANOMRATE 0x02
+#define ANOMNOISE 0x04
+#define ANOMDRIFT 0x08
+
+// Structures ##########################################
+typedef struct anomcfg {
+	double stuckeps;        // smallest change that counts as movement
+	double maxrate;         // units a second
+	double noisefloor;      // window sd of changes never flagged below this
+	double driftfloor;      // window mean never flagged closer than this to the mean
+}anomcfg_s;
+
+typedef struct anomaly {
+	anomcfg_s cfg;
+	long n;                 // Welford over the samples of the baseline
+	double mean;
+	double m2;
+	double basesd;          // sd of the baseline, 0 while it is being learnt
+	time_t base;            // start of the baseline
+	long dn;                // Welford over the changes between samples
+	double dmean;
+	double dm2;
+	int32_t ring[ANOMWINDOW];
+	int pos;                // next slot, the oldest once the window is full
+	int count;
+	int64_t sum;            // of the window
+	int64_t sumsq;
+	int64_t dsumsq;         // of the changes within the window
+	int sincejump;          // samples since a rate anomaly, up to ANOMWINDOW
+	double last;
+	time_t lastt;
+	time_t first;
+	double stuckv;          // value when it last moved
+	time_t moved;
+	unsigned int flags;
+	long raised[ANOMKINDS];
+}anomaly_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+void GhAnomalyInit(anomaly_s * a, anomcfg_s cfg);
+unsigned int GhAnomalyUpdate(anomaly_s * a, double value, time_t t);
+alarm_s * GhAnomalyAlarms(alarm_s * head, reading_s rdata, unsigned int mask);
+void GhAnomalyRebase(time_t t);
+void GhAnomalyReport(FILE * fp);
+/// @endcond
+#endif
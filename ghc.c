@@ -1,49 +1,639 @@
 /** Defines the entry point for the console application.
- * @version ghc.c 2020-03-12
+ * @version ghc.c 2026-10-19
  * @author Braydon Giallombardo
  */
+#define _GNU_SOURCE
 #include "ghcontrol.h"
-int main(void) {
+#include "ghplant.h"
+#include "ghevent.h"
+#include "shsim.h"
+#include "ghfleet.h"
+#include "ghsched.h"
+#include "ghcompress.h"
+#include "ghnotify.h"
+#include "ghrt.h"
+#include "ghw1.h"
+#include "ghjoy.h"
+#include "ghstate.h"
+#include "ghanomaly.h"
+#include <sys/socket.h>
+#include <sys/un.h>
 
-	// Variables
-	time_t now;
-	int logged;
-	reading_s creadings = {0};
-	control_s ctrl = {0};
-	setpoint_s sets = {0};
-	setpoint_s spts = {0};
-	alarmlimit_s alimits = {0};
-	alarm_s * arecord;
-	arecord = (alarm_s *) calloc(1,sizeof(alarm_s));
-	if(arecord == NULL) {
-		printf("\nCannot allocate memory\n");
+static ghstate_s gh = {0};
+static int quiet;           // suppress the per tick console output
+static char * profile;      // weather profile when the plant simulator is used
+static char * outbox;       // store and forward directory for the collector
+static int adaptive;        // sample each sensor on its own adaptive interval
+static int tickfd = -1;     // timer driving GhTick
+static int compress;        // log through the compressor
+static int fleetbox;        // the outbox is open, so acknowledgements are read
+static int fleetfd = -1;    // collector socket watched for acknowledgements
+static long fleetconns;
+static char * w1root;       // 1-Wire sysfs root when DS18B20 probes are used
+static char * joydev;       // joystick device or recording
+static char * statefile = STATEFILE;
+static char * logfile;      // text or compressed log, NULL for the default of the run
+
+/** Sends every alarm raised or cleared since the previous tick to the
+ * collector and the notification sinks
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param before GhAlarmMask of the previous tick
+ * @param after GhAlarmMask of this tick
+ */
+static void GhAlarmTransitions(unsigned int before, unsigned int after) {
+	alarm_s * alarm;
+	double value;
+
+	for (int code = 1; code < NALARMS; code++) {
+		if (!((before ^ after) & (1u << code))) {
+			continue;
+		}
+		alarm = GhFindAlarm(gh.arecord, (alarm_e) code);
+		value = alarm != NULL ? alarm->value : 0.0;
+		GhFleetAlarm((alarm_e) code, gh.creadings.rtime, value, alarm != NULL);
+		GhNotifyPost((alarm_e) code, alarm != NULL, gh.creadings.rtime, value);
+	}
+}
+
+/** Gets the time until the next sensor is due
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return milliseconds, at least 1
+ */
+static int GhSchedDelay(void) {
+	long long wait = GhSchedNext() - GhClockMillis();
+	return wait < 1 ? 1 : (int) wait;
+}
+
+/** Takes collector acknowledgements as they arrive so a backlog drains
+ * at network speed rather than one window per tick
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhFleetEvent(int fd, uint32_t events, void * ctx) {
+	GhFleetPump(0);
+}
+
+/** Watches the collector socket, again after the client reconnected.
+ * Only with an outbox: nothing else reads the socket, and a pending error
+ * or end of stream would keep it readable.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhFleetWatch(void) {
+	fleetstats_s fs = GhFleetStats();
+
+	if (!fleetbox || (fs.connects == fleetconns && GhFleetFd() == fleetfd)) {
+		return;
+	}
+	if (fleetfd != -1) {
+		GhEventRemoveFd(fleetfd);
+	}
+	fleetfd = GhFleetFd();
+	fleetconns = fs.connects;
+	if (fleetfd != -1) {
+		GhEventAddFd(fleetfd, EPOLLIN, GhFleetEvent, NULL);
+	}
+}
+
+/** Runs one control cycle: read, log, control, alarm, display
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhTick(int fd, uint32_t events, void * ctx) {
+	unsigned int mask, due = SCHEDALL;
+	int logged, delay;
+
+	GhRtWake(fd != -1);
+	GhGetSetpoints();
+	if (adaptive) {
+		due = GhSchedDue(GhClockMillis());
+	}
+	GhRtBegin(RTREAD);
+	gh.creadings=GhGetReadingsMask(due);
+	GhSensorStart(gh.creadings.rtime);
+	GhRtEnd(RTREAD);
+	GhRtBegin(RTLOG);
+	if (compress) {
+		GhCompressAdd(gh.creadings);
+		logged = 1;
+	}
+	else {
+		logged = GhLogData(logfile, gh.creadings);
+	}
+	GhRtEnd(RTLOG);
+	GhRtBegin(RTCONTROL);
+	gh.ctrl=GhSetControlsBand(gh.spts, gh.creadings, gh.ctrl, TBAND, HBAND);
+	GhSetActuators(gh.ctrl);
+	GhRtEnd(RTCONTROL);
+	GhRtBegin(RTALARM);
+	mask = GhAlarmMask(gh.arecord);
+	gh.arecord=GhSetAlarms(gh.arecord, gh.alimits, gh.creadings);
+	gh.arecord=GhAnomalyAlarms(gh.arecord, gh.creadings, due);
+	GhRtEnd(RTALARM);
+	GhRtBegin(RTSEND);
+	GhFleetReading(gh.creadings);
+	GhAlarmTransitions(mask, GhAlarmMask(gh.arecord));
+	if (!GhClockIsVirtual()) {
+		GhFleetWatch();
+		GhStateSave(&gh, gh.creadings.rtime);
+	}
+	GhRtEnd(RTSEND);
+	if (adaptive) {
+		GhSchedUpdate(due, gh.creadings, gh.spts, gh.alimits, TBAND, HBAND, GhClockMillis());
+		if (tickfd != -1) {
+			delay = GhSchedDelay();
+			GhEventSetTimer(tickfd, delay, 0);
+			GhRtArm(delay, 0);
+		}
+	}
+	GhRtBegin(RTDISPLAY);
+	GhDisplayAll(gh.creadings, gh.spts);
+	GhJoyDisplay(gh.creadings.rtime);
+	if (!quiet) {
+		GhDisplayReadings(gh.creadings);
+		GhDisplaySetpoints(gh.spts);
+		GhDisplayControls(gh.ctrl);
+		GhDisplayAlarms(gh.arecord);
+		GhSensorDisplay(gh.creadings.rtime);
+	}
+	if (GhRtIsEnabled()) {
+		// stdout is fully buffered in real-time mode, one write per tick
+		fflush(stdout);
+	}
+	GhRtEnd(RTDISPLAY);
+	GhRtEnd(RTTICK);
+}
+
+/** Switches to new setpoints at once: re-evaluates the controls and redraws
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param cpoints new setpoints
+ */
+static void GhApplySetpoints(setpoint_s cpoints) {
+	int left;
+
+	if (cpoints.temperature != gh.spts.temperature || cpoints.humidity != gh.spts.humidity) {
+		GhAnomalyRebase(GhClockNow());
+	}
+	gh.spts = cpoints;
+	if (adaptive) {
+		// New thresholds: sample everything soon and relearn the intervals.
+		// Only ever sooner, or a held key would keep postponing the tick.
+		GhSchedWake(GhClockMillis() + GHUPDATE);
+		left = tickfd != -1 ? GhEventTimerLeft(tickfd) : 0;
+		if (tickfd != -1 && (left < 0 || left > GHUPDATE)) {
+			GhEventSetTimer(tickfd, GHUPDATE, 0);
+			GhRtArm(GHUPDATE, 0);
+		}
+	}
+	gh.ctrl = GhSetControlsBand(gh.spts, gh.creadings, gh.ctrl, TBAND, HBAND);
+	GhSetActuators(gh.ctrl);
+	GhDisplayAll(gh.creadings, gh.spts);
+	GhJoyDisplay(GhClockNow());
+	GhDisplaySetpoints(gh.spts);
+	GhDisplayControls(gh.ctrl);
+}
+
+/** Reloads setpoints.dat as soon as it changes
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhSetpointsChanged(int fd, uint32_t events, void * ctx) {
+	setpoint_s cpoints;
+
+	if (GhRetrieveSetpoints("setpoints.dat", &cpoints)) {
+		GhApplySetpoints(cpoints);
+	}
+}
+
+/** Nudges the setpoints from the joystick; a middle press saves them to
+ * setpoints.dat so they survive a restart
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param key evdev key code
+ */
+static void GhJoyKey(int key) {
+	if (key == KEY_ENTER) {
+		GhSaveSetpoints("setpoints.dat", gh.spts);
+		return;
+	}
+	GhApplySetpoints(GhJoyNudge(gh.spts, key, GhClockNow()));
+}
+
+/** Answers a status socket client with the latest readings and controls
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhStatusClient(int fd, uint32_t events, void * ctx) {
+	char msg[128];
+	int cfd, len;
+
+	while ((cfd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+		len = snprintf(msg, sizeof(msg), "%ld,%3.1lf,%3.1lf,%5.1lf,%d,%d\n",
+			(long) gh.creadings.rtime, gh.creadings.temperature, gh.creadings.humidity,
+			gh.creadings.pressure, gh.ctrl.heater, gh.ctrl.humidifier);
+		if (write(cfd, msg, len) != len) {
+			fprintf(stdout, "\nStatus client write failed\n");
+		}
+		close(cfd);
+	}
+}
+
+/** Opens the non-blocking local status socket
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param sname path of the socket
+ * @return listening descriptor, -1 on error
+ */
+static int GhStatusOpen(const char * sname) {
+	struct sockaddr_un addr = {0};
+	int sfd;
+
+	sfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (sfd == -1) {
+		return -1;
+	}
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, sname, sizeof(addr.sun_path) - 1);
+	unlink(sname);
+	if (bind(sfd, (struct sockaddr *) &addr, sizeof(addr)) == -1 || listen(sfd, 8) == -1) {
+		close(sfd);
+		return -1;
+	}
+	return sfd;
+}
+
+/** Stops the loop on SIGINT, SIGTERM or SIGHUP
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhShutdown(int fd, uint32_t signo, void * ctx) {
+	fprintf(stdout, "\nSignal %u, shutting down\n", signo);
+	GhEventStop();
+}
+
+/** Prints command line usage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhUsage(const char * pname) {
+	fprintf(stdout, "Usage: %s [-s] [-f permille[:busypolls[:stuck]]] [-p profile] [-n ticks [-t start]] [-q]\n"
+		"          [-c host:port [-u] [-i source] [-o outbox]] [-a min:max]\n"
+		"          [-z sdt|deadband[:terr:herr:perr[:heartbeat]]] [-N sink]... [-r cpu[:priority]]\n"
+		"          [-w w1root] [-j auto|device|recording] [-k statefile] [-P fifo|mean] [-l logfile]\n"
+		"       %s -x ghdata.cmp\n"
+		"       %s [-r cpu[:priority]] -L loops[:us]\n"
+		"  -s  use the simulated Sense HAT bus instead of I2C\n"
+		"  -f  inject bus errors and slow or stuck one-shots into the simulated bus\n"
+		"  -p  read from the greenhouse plant simulator under a weather profile\n"
+		"      (temperate, winter, summer, arid)\n"
+		"  -n  run ticks cycles on a virtual clock as fast as possible, then exit\n"
+		"  -t  virtual clock start in seconds since the epoch (default now)\n"
+		"  -q  do not print readings, setpoints, controls and alarms every tick\n"
+		"  -c  send readings and alarm transitions to a fleet collector\n"
+		"  -u  use TCP instead of UDP for the collector\n"
+		"  -i  source number identifying this controller (default 1)\n"
+		"  -o  keep collector records in an outbox directory until acknowledged\n"
+		"  -a  sample each sensor every min to max ms, adapting to how fast it\n"
+		"      moves and how close it is to setpoints and alarm limits\n"
+		"  -z  log only the points needed to rebuild every sensor\n"
+		"      within its error, and at least one every heartbeat seconds\n"
+		"  -N  notify alarm transitions to exec:command, unix:/socket, file:/path\n"
+		"      or fake[:failevery[:delayms]], at most once a minute per alarm\n"
+		"  -r  run the control loop under SCHED_FIFO on one core (-1 any) with\n"
+		"      locked memory, and report every tick stage against its budget\n"
+		"  -w  read every DS18B20 probe under a 1-Wire sysfs root, such as\n"
+		"      " W1ROOT ", converting them all at once off the loop\n"
+		"  -j  nudge setpoints with the Sense HAT joystick: left/right select,\n"
+		"      up/down change, middle saves; a file of recorded events is replayed\n"
+		"  -k  checkpoint file (default " STATEFILE "); every real run saves the\n"
+		"      controller to it each tick and resumes from it on start\n"
+		"  -P  let the LPS25H sample on its own into its FIFO and drain it each\n"
+		"      cycle, averaging every sample (fifo) or reading its 32 sample mean (mean)\n"
+		"  -L  measure timer wakeup latency every us (default 1000), then exit\n"
+		"  -l  log to logfile instead of " GHLOG ", or " COMPLOG " with -z; a virtual\n"
+		"      run logs to " VIRTLOG " or " VIRTCOMPLOG " unless told otherwise\n"
+		"  -x  print a compressed log rebuilt at GHUPDATE steps as ghdata.txt rows\n", pname, pname, pname);
+}
+
+/** Prints a compressed log rebuilt at every GHUPDATE
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the compressed log
+ * @return 1 if successful, 0 if it cannot be read
+ */
+static int GhExpand(const char * fname) {
+	compseries_s series[SENSORS];
+	time_t first, last;
+
+	if (!GhCompressLoad(fname, series)) {
+		fprintf(stderr, "%s is not a compressed log\n", fname);
 		return 0;
 	}
+	GhCompressSpan(series, &first, &last);
+	for (time_t t = first; first != 0 && t <= last; t += GHUPDATE / 1000) {
+		GhWriteLogRow(stdout, GhCompressReading(series, t));
+	}
+	GhCompressFree(series);
+	return 1;
+}
+
+/** Runs the control pipeline on the virtual clock without waiting
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param ticks number of GHUPDATE cycles to run
+ */
+static void GhRunVirtual(long ticks) {
+	long long wstart, wms, vstart, vend;
+	long n = 0;
+
+	vstart = GhClockMillis();
+	vend = vstart + (long long) ticks * GHUPDATE;
+	wstart = GhRealClock.millis();
+	while (GhClockMillis() < vend) {
+		GhTick(-1, 0, NULL);
+		GhDelay(adaptive ? GhSchedDelay() : GHUPDATE);
+		n++;
+	}
+	wms = GhRealClock.millis() - wstart;
+	fprintf(stdout, "\n%ld ticks, %.2lf simulated days in %lld ms (%.0lf ticks/s)\n",
+		n, (GhClockMillis() - vstart) / 86400000.0, wms, n * 1000.0 / (wms > 0 ? wms : 1));
+	if (adaptive) {
+		GhSchedReport(stdout, GhClockMillis() - vstart);
+	}
+	if (compress) {
+		GhCompressReport(stdout);
+	}
+	if (profile != NULL) {
+		GhPlantReport(stdout);
+	}
+	else if (!ShGetBus()->hardware) {
+		fprintf(stdout, "Simulated bus: %ld HTS221 and %ld LPS25H transfers, %ld ms waited\n",
+			ShSimDevice(HTS221I2CADDRESS)->transfers, ShSimDevice(LPS25HI2CADDRESS)->transfers,
+			ShSimDelayed() / 1000);
+	}
+}
+
+/** Prints the fleet client counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhFleetReport(void) {
+	fleetstats_s fs = GhFleetStats();
+	outboxstats_s os = GhOutboxStats();
+
+	fprintf(stdout, "Fleet: %ld frames, %ld records sent, %ld frames dropped\n",
+		fs.frames, fs.records, fs.dropped);
+	if (outbox != NULL) {
+		fprintf(stdout, "Outbox: %ld appended, %ld acknowledged frames, %ld resent, "
+			"%lld bytes pending in %ld segments, %ld evicted, %ld corrupt\n",
+			os.appended, fs.acked, fs.resent, os.pending, os.segments, os.evicted, os.corrupt);
+	}
+}
+
+/** Prints the probe and 1-Wire counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhProbeReport(void) {
+	w1stats_s ws = GhW1Stats();
+
+	GhSensorReport(stdout);
+	if (w1root != NULL) {
+		fprintf(stdout, "1-Wire: %ld cycles, %ld bulk, %ld starts skipped, last %ld ms, longest %ld ms\n",
+			ws.cycles, ws.bulk, ws.skipped, ws.lastms, ws.maxms);
+	}
+}
 
+int main(int argc, char * argv[]) {
 
+	// Variables
+	int sfd, opt, tcp = 0, schedmin = 0, schedmax = 0, heartbeat = 0, cmode = COMPSDT;
+	int realtime = 0, rtcpu = -1, rtprio = 0, benchus = 0, pmode = LPS25HONESHOT;
+	long benchloops = 0;
+	double cerr[SENSORS] = {0};
+	char cname[16] = "";
+	long ticks = 0;
+	uint32_t source = 1;
+	char * collector = NULL;
+	time_t vstart = 0;
+	shfault_s fault = {0};
+	setpoint_s cpoints;
+
+	while ((opt = getopt(argc, argv, "sf:p:n:t:qc:ui:o:a:z:x:N:r:L:w:j:k:P:l:h")) != -1) {
+		switch (opt) {
+		case 's':
+			ShSetBus(&ShSimBus);
+			ShSimSetClock(GhClockMillis);
+			break;
+		case 'f':
+			sscanf(optarg, "%d:%d:%d", &fault.errorpermille, &fault.busypolls, &fault.stuck);
+			ShSimSetFault(HTS221I2CADDRESS, fault);
+			ShSimSetFault(LPS25HI2CADDRESS, fault);
+			break;
+		case 'p':
+			profile = optarg;
+			ShSetBus(&ShSimBus);
+			break;
+		case 'n':
+			ticks = atol(optarg);
+			break;
+		case 't':
+			vstart = (time_t) atoll(optarg);
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		case 'c':
+			collector = optarg;
+			break;
+		case 'u':
+			tcp = 1;
+			break;
+		case 'i':
+			source = (uint32_t) strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			outbox = optarg;
+			break;
+		case 'z':
+			compress = 1;
+			sscanf(optarg, "%15[a-z]:%lf:%lf:%lf:%d", cname, &cerr[0], &cerr[1], &cerr[2], &heartbeat);
+			cmode = strcmp(cname, "deadband") == 0 ? COMPDEADBAND : COMPSDT;
+			break;
+		case 'x':
+			return GhExpand(optarg) ? 0 : 1;
+		case 'a':
+			adaptive = 1;
+			sscanf(optarg, "%d:%d", &schedmin, &schedmax);
+			break;
+		case 'N':
+			if (!GhNotifyAddSink(optarg)) {
+				fprintf(stdout, "\nNotification sink %s not understood\n", optarg);
+				return 0;
+			}
+			break;
+		case 'r':
+			realtime = 1;
+			sscanf(optarg, "%d:%d", &rtcpu, &rtprio);
+			break;
+		case 'L':
+			sscanf(optarg, "%ld:%d", &benchloops, &benchus);
+			break;
+		case 'w':
+			w1root = optarg;
+			break;
+		case 'j':
+			joydev = optarg;
+			break;
+		case 'k':
+			statefile = optarg;
+			break;
+		case 'l':
+			logfile = optarg;
+			break;
+		case 'P':
+			pmode = strcmp(optarg, "fifo") == 0 ? LPS25HFIFO : (strcmp(optarg, "mean") == 0 ? LPS25HFIFOMEAN : -1);
+			if (pmode == -1) {
+				GhUsage(argv[0]);
+				return 0;
+			}
+			break;
+		default:
+			GhUsage(argv[0]);
+			return 0;
+		}
+	}
+	if (realtime && !GhRtEnable(rtcpu, rtprio)) {
+		fprintf(stdout, "\nReal-time mode incomplete, timing anyway\n");
+	}
+	if (benchloops > 0) {
+		GhRtBench(benchloops, benchus, stdout);
+		return 1;
+	}
+	gh.arecord = GhAlarmNew();
+	if(gh.arecord == NULL) {
+		printf("\nCannot allocate memory\n");
+		return 0;
+	}
 
 	// Initialization
+	if (ticks > 0) {
+		GhClockSetVirtual(vstart != 0 ? vstart : GhRealClock.now());
+	}
+	if (profile != NULL) {
+		if (!GhPlantInit(profile, GhClockNow())) {
+			return 0;
+		}
+		GhSetSource(&GhPlantSource);
+	}
 	GhControllerInit();
-	spts=GhSetSetpoints();
-	alimits=GhSetAlarmLimits();
-	// Loop
-	while(1) {
-		now = time(NULL);
-		GhGetSetpoints();
-		creadings=GhGetReadings();
-		logged = GhLogData("ghdata.txt", creadings);
-		ctrl=GhSetControls(spts, creadings);
-		arecord=GhSetAlarms(arecord, alimits, creadings);
-		GhDisplayAll(creadings, spts);
-		GhDisplayReadings(creadings);
-		GhDisplaySetpoints(spts);
-		GhDisplayControls(ctrl);
-		GhDisplayAlarms(arecord);
-		GhDelay(GHUPDATE);
+	if (pmode != LPS25HONESHOT && !ShLPS25HSetMode(pmode)) {
+		fprintf(stdout, "\nLPS25H FIFO unavailable\n");
+	}
+	if (w1root != NULL && GhW1Init(w1root) < 0) {
+		fprintf(stdout, "\n1-Wire devices %s unavailable\n", w1root);
+	}
+	// A checkpoint of the running controller, not of a virtual run
+	if (ticks == 0 && GhStateOpen(statefile) && GhStateLoad(&gh, GhClockNow())) {
+		if (GhRetrieveSetpoints("setpoints.dat", &cpoints)) {
+			gh.spts = cpoints;
+		}
+		else {
+			GhSaveSetpoints("setpoints.dat", gh.spts);
+		}
+		fprintf(stdout, "\nResumed from %s, %ld s old\n", statefile, GhStateStats().age);
+	}
+	else {
+		gh.spts=GhSetSetpoints();
+		gh.alimits=GhSetAlarmLimits();
+	}
+	if (adaptive) {
+		GhSchedInit(schedmin, schedmax, GhClockMillis());
 	}
+	if (logfile == NULL) {
+		logfile = compress ? (ticks > 0 ? VIRTCOMPLOG : COMPLOG) : (ticks > 0 ? VIRTLOG : GHLOG);
+	}
+	if (compress && !GhCompressOpen(logfile, cmode, cerr, heartbeat)) {
+		return 0;
+	}
+	if (collector != NULL && !GhFleetOpen(collector, source, tcp)) {
+		fprintf(stdout, "\nCollector %s unavailable\n", collector);
+	}
+	if (collector != NULL && outbox != NULL) {
+		fleetbox = GhFleetUseOutbox(outbox);
+		if (!fleetbox) {
+			fprintf(stdout, "\nOutbox %s unavailable\n", outbox);
+		}
+	}
+	GhNotifyStart();
+	if (ticks > 0) {
+		GhRunVirtual(ticks);
+		GhNotifyStop();
+		GhNotifyReport(stdout);
+		GhSensorClose();
+		GhProbeReport();
+		GhAnomalyReport(stdout);
+		GhRtReport(stdout);
+		GhCompressClose();
+		if (collector != NULL) {
+			GhFleetClose();
+			GhFleetReport();
+		}
+		#if SENSEHAT
+			ShExit();
+		#endif
+		return 1;
+	}
+	if (!GhEventInit()) {
+		return 0;
+	}
+	GhEventAddSignals(GhShutdown, NULL);
+	tickfd = GhEventAddTimer(GHUPDATE, GhTick, NULL);
+	if (tickfd == -1) {
+		return 0;
+	}
+	GhRtArm(GHUPDATE, 1);
+	GhEventWatchFile("./setpoints.dat", GhSetpointsChanged, NULL);
+	if (joydev != NULL && !GhJoyOpen(joydev, GhJoyKey)) {
+		fprintf(stdout, "\nJoystick %s unavailable\n", joydev);
+	}
+	sfd = GhStatusOpen(GHSOCKET);
+	if (sfd == -1 || !GhEventAddFd(sfd, EPOLLIN, GhStatusClient, NULL)) {
+		fprintf(stdout, "\nStatus socket %s unavailable\n", GHSOCKET);
+	}
+
+	// Loop
+	GhTick(-1, 0, NULL);
+	GhEventRun();
 
 	// Exit
-	fprintf(stdout,"\n\nPress ENTER to continue...");
-	getchar();
+	GhNotifyStop();
+	GhNotifyReport(stdout);
+	GhSensorClose();
+	GhProbeReport();
+	GhAnomalyReport(stdout);
+	GhRtReport(stdout);
+	GhCompressClose();
+	if (collector != NULL) {
+		GhFleetClose();
+		GhFleetReport();
+	}
+	if (joydev != NULL) {
+		GhJoyClose();
+		fprintf(stdout, "Joystick: %ld events, %ld presses, %ld setpoint nudges\n",
+			GhJoyStats().events, GhJoyStats().presses, GhJoyStats().nudges);
+	}
+	GhStateClose();
+	GhEventExit();
+	if (sfd != -1) {
+		close(sfd);
+		unlink(GHSOCKET);
+	}
+	#if SENSEHAT
+		ShExit();
+	#endif
 	return 1;
 }
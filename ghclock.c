@@ -0,0 +1,139 @@
+/** Clock functions
+ * Every time source of the controller goes through the selected clock.
+ * The real clock reads the system clocks, the virtual clock only moves
+ * when it is advanced so runs can go faster than real time.
+ * @version ghclock.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include "ghclock.h"
+
+static long long vms;   // virtual time in milliseconds since the epoch
+
+/** Real wall clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return seconds since the epoch
+ */
+static time_t GhRealNow(void) {
+	return time(NULL);
+}
+
+/** Real monotonic clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return milliseconds since an arbitrary start
+ */
+static long long GhRealMillis(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** Real sleep
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param milliseconds time to sleep
+ */
+static void GhRealSleep(int milliseconds) {
+	struct timespec ts;
+	ts.tv_sec = milliseconds / 1000;
+	ts.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+	// Only a signal leaves time to sleep, EINVAL would retry forever
+	while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+	}
+}
+
+/** Virtual wall clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return seconds since the epoch
+ */
+static time_t GhVirtualNow(void) {
+	return (time_t)(vms / 1000);
+}
+
+/** Virtual monotonic clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return milliseconds since the epoch
+ */
+static long long GhVirtualMillis(void) {
+	return vms;
+}
+
+/** Virtual sleep, advances the clock instead of waiting
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param milliseconds time to skip
+ */
+static void GhVirtualSleep(int milliseconds) {
+	vms += milliseconds;
+}
+
+const ghclock_s GhRealClock = { 0, GhRealNow, GhRealMillis, GhRealSleep };
+const ghclock_s GhVirtualClock = { 1, GhVirtualNow, GhVirtualMillis, GhVirtualSleep };
+static const ghclock_s * clk = &GhRealClock;
+
+/** Selects the clock used by the controller
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param nclock clock to use, NULL restores the real clock
+ */
+void GhSetClock(const ghclock_s * nclock) {
+	clk = (nclock == NULL) ? &GhRealClock : nclock;
+}
+
+/** Tells whether time is simulated
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 for the virtual clock, 0 for the real clock
+ */
+int GhClockIsVirtual(void) {
+	return clk->virtual;
+}
+
+/** Gets the current wall clock time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return seconds since the epoch
+ */
+time_t GhClockNow(void) {
+	return clk->now();
+}
+
+/** Gets a monotonic time stamp for measuring intervals
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return milliseconds
+ */
+long long GhClockMillis(void) {
+	return clk->millis();
+}
+
+/** Sleeps on the current clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param milliseconds time to wait
+ */
+void GhClockSleep(int milliseconds) {
+	clk->sleep(milliseconds);
+}
+
+/** Switches to the virtual clock and sets its time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param start wall clock time the virtual clock starts at
+ */
+void GhClockSetVirtual(time_t start) {
+	vms = (long long) start * 1000;
+	clk = &GhVirtualClock;
+}
+
+/** Moves the virtual clock forward
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param milliseconds time to skip
+ */
+void GhClockAdvance(long long milliseconds) {
+	vms += milliseconds;
+}
@@ -0,0 +1,31 @@
+/** Clock constants, structures, function prototypes
+ * @version ghclock.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHCLOCK_H
+#define GHCLOCK_H
+
+#include <errno.h>
+#include <time.h>
+
+// Structures ##########################################
+typedef struct ghclock {
+	int virtual;
+	time_t (*now)(void);
+	long long (*millis)(void);
+	void (*sleep)(int milliseconds);
+}ghclock_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+extern const ghclock_s GhRealClock;
+extern const ghclock_s GhVirtualClock;
+void GhSetClock(const ghclock_s * nclock);
+int GhClockIsVirtual(void);
+time_t GhClockNow(void);
+long long GhClockMillis(void);
+void GhClockSleep(int milliseconds);
+void GhClockSetVirtual(time_t start);
+void GhClockAdvance(long long milliseconds);
+/// @endcond
+#endif
@@ -0,0 +1,553 @@
+/** Fleet collector daemon
+ * Receives batched frames from many ghc instances over UDP and TCP on one
+ * epoll loop, tracks per-source sequence numbers for loss detection and
+ * appends every record to an hourly partitioned store. With -g it instead
+ * plays many simulated controllers against a collector.
+ * @version ghcollect.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include "ghfleet.h"
+#include "ghevent.h"
+
+// Constants ##############################################
+#define COLLECTSOURCES 65536    // source table slots, a power of two
+#define COLLECTWINDOW 64        // frames behind the newest still accepted late
+#define COLLECTJUMP (COLLECTWINDOW * 16) // frames apart beyond which another session is assumed
+#define COLLECTPARTS 4          // store partitions kept open
+#define COLLECTRECV 64          // datagrams per recvmmsg
+#define COLLECTSTATS 10000      // ms between statistics lines
+#define COLLECTPATHSZ 256
+
+// Structures ##########################################
+typedef struct session {
+	int used;
+	uint32_t first;         // sequence number the session started with
+	uint32_t next;          // sequence number expected next
+	uint64_t window;        // bit i set: frame next - 1 - i was received
+}session_s;
+
+typedef struct source {
+	uint32_t id;
+	int used;
+	session_s cur;
+	session_s prev;         // session before, for its frames resent late
+	long frames;
+	long records;
+	long lost;
+	long dups;
+}source_s;
+
+typedef struct conn {
+	int fd;
+	size_t len;
+	uint8_t buf[FLEETMAXFRAME];
+}conn_s;
+
+typedef struct part {
+	long hour;              // hours since the epoch
+	FILE * fp;
+	long used;
+}part_s;
+
+static source_s * sources;
+static long nsources;
+static part_s parts[COLLECTPARTS];
+static long partuse;
+static char storedir[COLLECTPATHSZ] = "store";
+static long totframes, totrecords, totbad;
+
+/** Finds or creates the table entry of a source
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return entry, NULL if the table is full
+ */
+static source_s * GhCollectSource(uint32_t id) {
+	uint32_t h = (id * 2654435761u) & (COLLECTSOURCES - 1);
+
+	for (long i = 0; i < COLLECTSOURCES; i++) {
+		source_s * s = &sources[(h + i) & (COLLECTSOURCES - 1)];
+		if (!s->used) {
+			s->used = 1;
+			s->id = id;
+			nsources++;
+			return s;
+		}
+		if (s->id == id) {
+			return s;
+		}
+	}
+	return NULL;
+}
+
+/** Gets the open store partition for an hour, opening it if needed
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return stream, NULL on error
+ */
+static FILE * GhCollectPart(long hour) {
+	char path[COLLECTPATHSZ + 32];
+	part_s * p = &parts[0];
+	struct tm tm;
+	time_t t;
+
+	for (int i = 0; i < COLLECTPARTS; i++) {
+		if (parts[i].fp != NULL && parts[i].hour == hour) {
+			parts[i].used = ++partuse;
+			return parts[i].fp;
+		}
+		if (parts[i].used < p->used) {
+			p = &parts[i];
+		}
+	}
+	if (p->fp != NULL) {
+		fclose(p->fp);
+	}
+	t = (time_t) hour * 3600;
+	gmtime_r(&t, &tm);
+	snprintf(path, sizeof(path), "%s/%04d%02d%02d%02d.ghs", storedir,
+		tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour);
+	p->fp = fopen(path, "ab");
+	p->hour = hour;
+	p->used = ++partuse;
+	if (p->fp != NULL) {
+		setvbuf(p->fp, NULL, _IOFBF, 1 << 16);
+	}
+	return p->fp;
+}
+
+/** Flushes every open partition
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectSync(void) {
+	for (int i = 0; i < COLLECTPARTS; i++) {
+		if (parts[i].fp != NULL) {
+			fflush(parts[i].fp);
+		}
+	}
+}
+
+/** Places a frame in a session, sequence numbers wrapping around
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param ss session
+ * @param seq sequence number of the frame
+ * @param lost counts frames skipped over, until they turn up late
+ * @return 1 if the frame is new, 0 for a duplicate, -1 if it is too far
+ * from the session to belong to it
+ */
+static int GhCollectTrack(session_s * ss, uint32_t seq, long * lost) {
+	int32_t ahead = (int32_t)(seq - ss->next);
+	uint32_t behind;
+
+	if (!ss->used || ahead >= COLLECTJUMP || ahead <= -COLLECTJUMP) {
+		return -1;
+	}
+	if (ahead >= 0) {
+		*lost += ahead;
+		ss->window = (ahead + 1 >= COLLECTWINDOW) ? 0 : ss->window << (ahead + 1);
+		ss->window |= 1;
+		ss->next = seq + 1;
+		return 1;
+	}
+	behind = ss->next - 1 - seq;
+	if (behind < COLLECTWINDOW && !(ss->window & (1ull << behind))) {
+		ss->window |= 1ull << behind;
+		(*lost)--;
+		return 1;
+	}
+	return 0;
+}
+
+/** Updates the sequence state of a source
+ * A frame far from the current session starts another: the controller
+ * restarted, and the FLEETFIRST frame of the new session may have been
+ * lost. The session before is kept so its frames resent after the restart
+ * are still recognised.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if the frame is new, 0 for a duplicate
+ */
+static int GhCollectSequence(source_s * s, uint32_t seq, int flags) {
+	int r = -1;
+
+	if (!(flags & FLEETFIRST) || (s->cur.used && seq == s->cur.first)) {
+		r = GhCollectTrack(&s->cur, seq, &s->lost);
+	}
+	if (r < 0 && (!(flags & FLEETFIRST) || (s->prev.used && seq == s->prev.first))) {
+		r = GhCollectTrack(&s->prev, seq, &s->lost);
+	}
+	if (r < 0) {
+		s->prev = s->cur;
+		s->cur.used = 1;
+		s->cur.first = seq;
+		s->cur.next = seq + 1;
+		s->cur.window = 1;
+		r = 1;
+	}
+	s->dups += r == 0;
+	return r;
+}
+
+/** Stores one frame and acknowledges it when asked to
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param buf frame bytes
+ * @param len frame length
+ * @param fd socket to acknowledge on
+ * @param addr UDP sender, NULL for TCP
+ * @param alen length of addr
+ */
+static void GhCollectFrame(const uint8_t * buf, size_t len, int fd, struct sockaddr * addr, socklen_t alen) {
+	uint8_t ack[FLEETHDRSZ], rec[4 + FLEETRECSZ];
+	fleethdr_s hdr;
+	fleetrec_s r;
+	source_s * s;
+	FILE * fp;
+
+	if ((size_t) GhFleetGetHeader(buf, len, &hdr) != len || hdr.type != FLEETDATA
+			|| (s = GhCollectSource(hdr.source)) == NULL) {
+		totbad++;
+		return;
+	}
+	if (GhCollectSequence(s, hdr.seq, hdr.flags)) {
+		for (int i = 0; i < hdr.count; i++) {
+			GhFleetGetRecord(buf + FLEETHDRSZ + i * FLEETRECSZ, &r);
+			fp = GhCollectPart((long)(r.time / 3600));
+			if (fp != NULL) {
+				rec[0] = hdr.source & 0xFF;
+				rec[1] = (hdr.source >> 8) & 0xFF;
+				rec[2] = (hdr.source >> 16) & 0xFF;
+				rec[3] = hdr.source >> 24;
+				memcpy(rec + 4, buf + FLEETHDRSZ + i * FLEETRECSZ, FLEETRECSZ);
+				fwrite(rec, sizeof(rec), 1, fp);
+			}
+		}
+		s->frames++;
+		s->records += hdr.count;
+		totframes++;
+		totrecords += hdr.count;
+	}
+	if (hdr.flags & FLEETWANTACK) {
+		hdr.type = FLEETACK;
+		hdr.count = 0;
+		hdr.flags = 0;
+		GhFleetPutHeader(ack, hdr);
+		sendto(fd, ack, sizeof(ack), MSG_DONTWAIT | MSG_NOSIGNAL, addr, alen);
+	}
+}
+
+/** Drains the UDP socket a batch of datagrams per system call
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectUdp(int fd, uint32_t events, void * ctx) {
+	static uint8_t bufs[COLLECTRECV][FLEETMAXFRAME];
+	static struct sockaddr_storage addrs[COLLECTRECV];
+	struct mmsghdr msgs[COLLECTRECV];
+	struct iovec iovs[COLLECTRECV];
+	int n;
+
+	do {
+		memset(msgs, 0, sizeof(msgs));
+		for (int i = 0; i < COLLECTRECV; i++) {
+			iovs[i].iov_base = bufs[i];
+			iovs[i].iov_len = FLEETMAXFRAME;
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_name = &addrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+		}
+		n = recvmmsg(fd, msgs, COLLECTRECV, MSG_DONTWAIT, NULL);
+		for (int i = 0; i < n; i++) {
+			GhCollectFrame(bufs[i], msgs[i].msg_len, fd,
+				(struct sockaddr *) &addrs[i], msgs[i].msg_hdr.msg_namelen);
+		}
+	} while (n == COLLECTRECV);
+}
+
+/** Reads a TCP connection and stores every complete frame
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectConn(int fd, uint32_t events, void * ctx) {
+	conn_s * c = ctx;
+	fleethdr_s hdr;
+	size_t flen, off;
+	ssize_t n;
+
+	for (;;) {
+		n = read(fd, c->buf + c->len, sizeof(c->buf) - c->len);
+		if (n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+			GhEventRemoveFd(fd);
+			close(fd);
+			free(c);
+			return;
+		}
+		if (n == -1) {
+			return;
+		}
+		c->len += n;
+		off = 0;
+		while (c->len - off >= FLEETHDRSZ) {
+			flen = GhFleetGetHeader(c->buf + off, c->len - off, &hdr);
+			if (flen == 0) {
+				// Not a frame boundary, the stream cannot be resynchronized
+				totbad++;
+				GhEventRemoveFd(fd);
+				close(fd);
+				free(c);
+				return;
+			}
+			if (c->len - off < flen) {
+				break;
+			}
+			GhCollectFrame(c->buf + off, flen, fd, NULL, 0);
+			off += flen;
+		}
+		memmove(c->buf, c->buf + off, c->len - off);
+		c->len -= off;
+	}
+}
+
+/** Accepts TCP controllers
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectAccept(int fd, uint32_t events, void * ctx) {
+	conn_s * c;
+	int cfd;
+
+	while ((cfd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+		c = calloc(1, sizeof(conn_s));
+		if (c == NULL || !GhEventAddFd(cfd, EPOLLIN, GhCollectConn, c)) {
+			free(c);
+			close(cfd);
+			continue;
+		}
+		c->fd = cfd;
+	}
+}
+
+/** Prints totals across every source
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectReport(FILE * fp) {
+	long lost = 0, dups = 0;
+
+	for (long i = 0; i < COLLECTSOURCES; i++) {
+		if (sources[i].used) {
+			lost += sources[i].lost;
+			dups += sources[i].dups;
+		}
+	}
+	fprintf(fp, "sources %ld  frames %ld  records %ld  lost %ld  duplicate %ld  malformed %ld\n",
+		nsources, totframes, totrecords, lost, dups, totbad);
+}
+
+/** Periodic statistics and store flush
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectTick(int fd, uint32_t events, void * ctx) {
+	GhCollectSync();
+	GhCollectReport(stdout);
+	fflush(stdout);
+}
+
+/** Stops the loop on SIGINT, SIGTERM or SIGHUP
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectStop(int fd, uint32_t signo, void * ctx) {
+	GhEventStop();
+}
+
+/** Opens a non-blocking listening socket on every IPv4 address
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return descriptor, -1 on error
+ */
+static int GhCollectListen(int port, int type) {
+	struct sockaddr_in addr = {0};
+	int fd, one = 1, rcvbuf = 1 << 22;
+
+	fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd == -1) {
+		return -1;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1
+			|| (type == SOCK_STREAM && listen(fd, SOMAXCONN) == -1)) {
+		perror("Error (call to 'bind')");
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/** Plays simulated controllers against a collector
+ * Every client sends frames of FLEETBATCH readings with its own source
+ * number and sequence, skipping dropmille per thousand frames so the
+ * collector's loss accounting can be checked. Frames skipped after a
+ * client's last sent frame cannot be told apart from the end of its run.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 0 if successful
+ */
+static int GhCollectLoad(const char * dest, uint32_t first, int clients, int frames, int tcp, int dropmille) {
+	uint8_t buf[FLEETMAXFRAME];
+	fleethdr_s hdr = { FLEETMAGIC, FLEETVERSION, FLEETDATA, 0, FLEETBATCH, 0, 0 };
+	reading_s rd = {0};
+	int * fds, sent = 0, skipped = 0;
+	long long start, ms;
+	unsigned int seed = 1;
+
+	fds = calloc(clients, sizeof(int));
+	if (fds == NULL) {
+		return 1;
+	}
+	for (int c = 0; c < clients; c++) {
+		fds[c] = (c == 0 || tcp) ? GhFleetConnect(dest, tcp) : fds[0];
+		if (fds[c] == -1) {
+			fprintf(stderr, "Cannot connect client %d to %s\n", c, dest);
+			return 1;
+		}
+	}
+	GhClockSetVirtual(GhRealClock.now());
+	start = GhRealClock.millis();
+	for (int f = 0; f < frames; f++) {
+		for (int c = 0; c < clients; c++) {
+			hdr.source = first + (uint32_t) c;
+			hdr.seq = (uint32_t) f;
+			GhFleetPutHeader(buf, hdr);
+			for (int i = 0; i < FLEETBATCH; i++) {
+				rd.rtime = GhClockNow() + i * 2;
+				rd.temperature = 20.0 + c % 10;
+				rd.humidity = 50.0 + i % 10;
+				rd.pressure = 1013.0;
+				GhFleetPutRecord(buf + FLEETHDRSZ + i * FLEETRECSZ, GhFleetFromReading(rd));
+			}
+			seed = seed * 1103515245u + 12345u;
+			if ((int)((seed >> 8) % 1000) < dropmille) {
+				skipped++;
+				continue;
+			}
+			// Blocking here is fine, the generator is not a controller
+			while (send(fds[c], buf, FLEETMAXFRAME, MSG_NOSIGNAL) == -1) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED) {
+					perror("Error (call to 'send')");
+					return 1;
+				}
+				usleep(100);
+			}
+			sent++;
+		}
+		GhClockAdvance(FLEETBATCH * 2000);
+	}
+	ms = GhRealClock.millis() - start;
+	fprintf(stdout, "%d clients sent %d frames (%d skipped) in %lld ms (%.0lf frames/s)\n",
+		clients, sent, skipped, ms, sent * 1000.0 / (ms > 0 ? ms : 1));
+	for (int c = 0; c < clients; c++) {
+		if (c == 0 || tcp) {
+			close(fds[c]);
+		}
+	}
+	free(fds);
+	return 0;
+}
+
+/** Prints command line usage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCollectUsage(const char * pname) {
+	fprintf(stderr, "Usage: %s [-p port] [-d storedir]\n"
+		"       %s -g host:port [-i first] [-n clients] [-f frames] [-t] [-x dropmille]\n"
+		"  -p  UDP and TCP port to listen on (default %d)\n"
+		"  -d  directory of the hourly store partitions (default store)\n"
+		"  -g  generate load from simulated controllers instead of collecting\n"
+		"  -i  source number of the first simulated controller (default 1)\n"
+		"  -n  simulated controllers   -f  frames each   -t  use TCP\n"
+		"  -x  frames per thousand each controller skips, to check loss accounting\n", pname, pname, FLEETPORT);
+}
+
+int main(int argc, char * argv[]) {
+	int opt, port = FLEETPORT, clients = 100, frames = 100, tcp = 0, dropmille = 0;
+	int ufd, tfd;
+	uint32_t first = 1;
+	char * load = NULL;
+
+	while ((opt = getopt(argc, argv, "p:d:g:i:n:f:tx:h")) != -1) {
+		switch (opt) {
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'd':
+			snprintf(storedir, sizeof(storedir), "%s", optarg);
+			break;
+		case 'g':
+			load = optarg;
+			break;
+		case 'i':
+			first = (uint32_t) strtoul(optarg, NULL, 10);
+			break;
+		case 'n':
+			clients = atoi(optarg);
+			break;
+		case 'f':
+			frames = atoi(optarg);
+			break;
+		case 't':
+			tcp = 1;
+			break;
+		case 'x':
+			dropmille = atoi(optarg);
+			break;
+		default:
+			GhCollectUsage(argv[0]);
+			return 1;
+		}
+	}
+	if (load != NULL) {
+		return GhCollectLoad(load, first, clients, frames, tcp, dropmille);
+	}
+
+	sources = calloc(COLLECTSOURCES, sizeof(source_s));
+	if (sources == NULL) {
+		return 1;
+	}
+	mkdir(storedir, 0755);
+	ufd = GhCollectListen(port, SOCK_DGRAM);
+	tfd = GhCollectListen(port, SOCK_STREAM);
+	if (ufd == -1 || tfd == -1 || !GhEventInit()) {
+		return 1;
+	}
+	GhEventAddSignals(GhCollectStop, NULL);
+	GhEventAddFd(ufd, EPOLLIN, GhCollectUdp, NULL);
+	GhEventAddFd(tfd, EPOLLIN, GhCollectAccept, NULL);
+	GhEventAddTimer(COLLECTSTATS, GhCollectTick, NULL);
+	fprintf(stdout, "Collecting on port %d into %s/\n", port, storedir);
+	fflush(stdout);
+	GhEventRun();
+
+	GhCollectUdp(ufd, 0, NULL);
+	GhCollectSync();
+	GhCollectReport(stdout);
+	GhEventExit();
+	close(ufd);
+	close(tfd);
+	free(sources);
+	return 0;
+}
@@ -0,0 +1,121 @@
+/** Columnar reading file functions
+ * Time stamps and each sensor are stored as separate fixed width columns,
+ * 10 bytes a row against about 40 for a GhLogData row, and a reader only
+ * converts numbers it needs.
+ * @version ghcolumn.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include "ghcolumn.h"
+#include "ghcrc.h"
+
+/** Writes columns to a file
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the file
+ * @param cols rows to write
+ * @return 1 if successful, 0 on error or if the rows span more than 136 years
+ */
+int GhColumnWrite(const char * fname, const columns_s * cols) {
+	colheader_s hdr = {0};
+	uint32_t * t;
+	int64_t lo, hi;
+	FILE * fp;
+	int ok;
+
+	lo = hi = cols->rows > 0 ? cols->t[0] : 0;
+	for (long i = 1; i < cols->rows; i++) {
+		lo = cols->t[i] < lo ? cols->t[i] : lo;
+		hi = cols->t[i] > hi ? cols->t[i] : hi;
+	}
+	if (hi - lo > UINT32_MAX) {
+		return 0;
+	}
+	t = malloc((cols->rows > 0 ? cols->rows : 1) * sizeof(uint32_t));
+	if (t == NULL) {
+		return 0;
+	}
+	for (long i = 0; i < cols->rows; i++) {
+		t[i] = (uint32_t)(cols->t[i] - lo);
+	}
+	hdr.magic = COLMAGIC;
+	hdr.version = COLVERSION;
+	hdr.rows = (uint64_t) cols->rows;
+	hdr.tbase = lo;
+	hdr.crc = GhCrc32(0, t, cols->rows * sizeof(uint32_t));
+	for (int s = 0; s < SENSORS; s++) {
+		hdr.crc = GhCrc32(hdr.crc, cols->v[s], cols->rows * sizeof(int16_t));
+	}
+	fp = fopen(fname, "wb");
+	if (fp == NULL) {
+		free(t);
+		return 0;
+	}
+	ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1
+		&& fwrite(t, sizeof(uint32_t), cols->rows, fp) == (size_t) cols->rows;
+	for (int s = 0; s < SENSORS && ok; s++) {
+		ok = fwrite(cols->v[s], sizeof(int16_t), cols->rows, fp) == (size_t) cols->rows;
+	}
+	ok = fclose(fp) == 0 && ok;
+	free(t);
+	return ok;
+}
+
+/** Reads a columnar file as readings
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the file
+ * @param rows receives the readings, every quality QGOOD, to free
+ * @return number of rows, -1 if it is not a columnar file, -2 if it is
+ * damaged or memory ran out
+ */
+long GhColumnRead(const char * fname, reading_s ** rows) {
+	colheader_s hdr;
+	uint32_t * t = NULL;
+	int16_t * v[SENSORS] = {NULL};
+	uint32_t crc;
+	reading_s * r = NULL;
+	long n = -2;
+	int ok;
+	FILE * fp;
+
+	fp = fopen(fname, "rb");
+	if (fp == NULL) {
+		return -1;
+	}
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != COLMAGIC) {
+		fclose(fp);
+		return -1;
+	}
+	if (hdr.version != COLVERSION) {
+		fclose(fp);
+		return -2;
+	}
+	t = malloc((hdr.rows + 1) * sizeof(uint32_t));
+	ok = t != NULL && fread(t, sizeof(uint32_t), hdr.rows, fp) == hdr.rows;
+	crc = ok ? GhCrc32(0, t, hdr.rows * sizeof(uint32_t)) : 0;
+	for (int s = 0; s < SENSORS && ok; s++) {
+		v[s] = malloc((hdr.rows + 1) * sizeof(int16_t));
+		ok = v[s] != NULL && fread(v[s], sizeof(int16_t), hdr.rows, fp) == hdr.rows;
+		crc = ok ? GhCrc32(crc, v[s], hdr.rows * sizeof(int16_t)) : 0;
+	}
+	fclose(fp);
+	if (ok && crc == hdr.crc) {
+		r = malloc((hdr.rows + 1) * sizeof(reading_s));
+	}
+	if (r != NULL) {
+		for (uint64_t i = 0; i < hdr.rows; i++) {
+			memset(&r[i], 0, sizeof(reading_s));
+			r[i].rtime = (time_t)(hdr.tbase + t[i]);
+			r[i].temperature = v[TEMPERATURE][i] / COLSCALE;
+			r[i].humidity = v[HUMIDITY][i] / COLSCALE;
+			r[i].pressure = v[PRESSURE][i] / COLSCALE;
+		}
+		*rows = r;
+		n = (long) hdr.rows;
+	}
+	free(t);
+	for (int s = 0; s < SENSORS; s++) {
+		free(v[s]);
+	}
+	return n;
+}
@@ -0,0 +1,41 @@
+/** Columnar reading file constants, structures, function prototypes
+ * @version ghcolumn.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHCOLUMN_H
+#define GHCOLUMN_H
+
+#include <stdint.h>
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define COLMAGIC 0x4c434847     // "GHCL"
+#define COLVERSION 1
+#define COLSCALE 10.0           // values are kept in tenths, as GhLogData prints them
+#define COLMIN -32768           // smallest value a column holds, in tenths
+#define COLMAX 32767
+
+// Structures ##########################################
+// Followed by rows uint32_t seconds after tbase, then rows int16_t
+// tenths of each of temperature, humidity and pressure
+typedef struct colheader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t rows;
+	int64_t tbase;          // earliest time stamp
+	uint32_t crc;           // of the columns
+	uint32_t pad;
+}colheader_s;
+
+typedef struct columns {
+	long rows;
+	int64_t * t;            // seconds
+	int16_t * v[SENSORS];   // tenths
+}columns_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhColumnWrite(const char * fname, const columns_s * cols);
+long GhColumnRead(const char * fname, reading_s ** rows);
+/// @endcond
+#endif
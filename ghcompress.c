@@ -0,0 +1,345 @@
+/** Reading log compression functions
+ * The writer keeps, per sensor, only the points needed to rebuild the
+ * series within its error bound. In swinging door mode every dropped
+ * point lies within the bound of the line between the archived points
+ * around it; the archived point is placed on that line rather than taken
+ * as measured, which is what makes the bound hold. In deadband mode every
+ * dropped point lies within the bound of the archived point before it.
+ * Readings that are not QGOOD, and quality changes, are always archived.
+ * @version ghcompress.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <math.h>
+#include "ghcompress.h"
+
+static FILE * cfp;
+static int cheartbeat = COMPHEARTBEAT;
+static compsensor_s csensors[SENSORS];
+static quality_e cquality[SENSORS];
+static const char compnames[SENSORS][12] = {"temperature","humidity","pressure"};
+
+/** Opens a compressed log for appending, writing its header if it is new
+ * A log written with another mode, error or heartbeat is refused, as its
+ * header would no longer describe the rows appended.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the file
+ * @param mode COMPSDT or COMPDEADBAND
+ * @param err error bound of each sensor, NULL for the defaults
+ * @param heartbeat longest gap in seconds between archived points
+ * @return 1 if successful, 0 on error
+ */
+int GhCompressOpen(const char * fname, int mode, const double err[SENSORS], int heartbeat) {
+	const double deferr[SENSORS] = { COMPTERR, COMPHERR, COMPPERR };
+	char hdr[COMPLINESZ], line[COMPLINESZ];
+	int len;
+
+	cheartbeat = heartbeat > 0 ? heartbeat : COMPHEARTBEAT;
+	memset(csensors, 0, sizeof(csensors));
+	len = snprintf(hdr, sizeof(hdr), "#ghcompress,%d,%d", COMPVERSION, cheartbeat);
+	for (int i = 0; i < SENSORS; i++) {
+		csensors[i].mode = mode;
+		csensors[i].err = (err != NULL && err[i] > 0) ? err[i] : deferr[i];
+		cquality[i] = QGOOD;
+		len += snprintf(hdr + len, sizeof(hdr) - len, ",%d,%.3lf", csensors[i].mode, csensors[i].err);
+	}
+	snprintf(hdr + len, sizeof(hdr) - len, "\n");
+	cfp = fopen(fname, "a+");
+	if (cfp == NULL) {
+		fprintf(stdout, "\nCan't open file, data not retrieved!\n");
+		return 0;
+	}
+	if (fgets(line, sizeof(line), cfp) == NULL) {
+		fseek(cfp, 0, SEEK_END);
+		fputs(hdr, cfp);
+		return 1;
+	}
+	else if (strcmp(line, hdr) != 0) {
+		fprintf(stdout, "\n%s was written with other compression settings, move it aside first\n", fname);
+		fclose(cfp);
+		cfp = NULL;
+		return 0;
+	}
+	// Switching from reading to writing needs a seek
+	fseek(cfp, 0, SEEK_END);
+	return 1;
+}
+
+/** Archives a point and makes it the start of the next door
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCompressEmit(int i, time_t t, double v, quality_e q) {
+	compsensor_s * s = &csensors[i];
+
+	// Keep what the reader will see, so later doors start from it
+	v = round(v * 100.0) / 100.0;
+	fprintf(cfp, "%ld,%d,%.2lf,%d\n", (long) t, i, v, (int) q);
+	// A crash must not take the unwritten buffer, hours of log at this rate
+	if (!GhClockIsVirtual()) {
+		fflush(cfp);
+	}
+	s->anchored = 1;
+	s->ta = t;
+	s->va = v;
+	s->pending = 0;
+	s->out++;
+}
+
+/** Archives the latest point of a sensor if it is not archived yet
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCompressPending(int i) {
+	compsensor_s * s = &csensors[i];
+
+	if (!s->pending) {
+		return;
+	}
+	if (s->mode == COMPSDT) {
+		GhCompressEmit(i, s->tp, s->va + (s->upper + s->lower) / 2.0 * (double)(s->tp - s->ta), QGOOD);
+	}
+	else {
+		GhCompressEmit(i, s->tp, s->vp, QGOOD);
+	}
+}
+
+/** Sets the door of the pending point from the archived point
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCompressDoor(compsensor_s * s, time_t t, double v, double err) {
+	s->upper = (v + err - s->va) / (double)(t - s->ta);
+	s->lower = (v - err - s->va) / (double)(t - s->ta);
+	s->pending = 1;
+	s->tp = t;
+	s->vp = v;
+}
+
+/** Adds a reading to the compressed log
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param rdata object of the structure readings named rdata
+ */
+void GhCompressAdd(reading_s rdata) {
+	const double value[SENSORS] = { rdata.temperature, rdata.humidity, rdata.pressure };
+	compsensor_s * s;
+	double v, err, upper, lower;
+	time_t t = rdata.rtime;
+
+	if (cfp == NULL) {
+		return;
+	}
+	for (int i = 0; i < SENSORS; i++) {
+		s = &csensors[i];
+		v = value[i];
+		s->in++;
+		if (rdata.quality[i] != QGOOD || rdata.quality[i] != cquality[i] || !s->anchored) {
+			GhCompressPending(i);
+			GhCompressEmit(i, t, v, rdata.quality[i]);
+			cquality[i] = rdata.quality[i];
+			continue;
+		}
+		if (t <= (s->pending ? s->tp : s->ta)) {
+			continue;
+		}
+		if (s->mode == COMPDEADBAND) {
+			if (fabs(v - s->va) > s->err || t - s->ta >= cheartbeat) {
+				GhCompressEmit(i, t, v, QGOOD);
+			}
+			else {
+				s->pending = 1;
+				s->tp = t;
+				s->vp = v;
+			}
+			continue;
+		}
+		// Leave room for the 0.01 rounding of archived values
+		err = s->err - 0.01;
+		if (!s->pending) {
+			GhCompressDoor(s, t, v, err);
+			continue;
+		}
+		upper = fmin(s->upper, (v + err - s->va) / (double)(t - s->ta));
+		lower = fmax(s->lower, (v - err - s->va) / (double)(t - s->ta));
+		if (lower > upper || t - s->ta > cheartbeat) {
+			GhCompressPending(i);
+			GhCompressDoor(s, t, v, err);
+		}
+		else {
+			s->upper = upper;
+			s->lower = lower;
+			s->tp = t;
+			s->vp = v;
+		}
+	}
+}
+
+/** Archives the latest points and closes the compressed log
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhCompressClose(void) {
+	if (cfp == NULL) {
+		return;
+	}
+	for (int i = 0; i < SENSORS; i++) {
+		GhCompressPending(i);
+	}
+	fclose(cfp);
+	cfp = NULL;
+}
+
+/** Prints points in and out per sensor
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ */
+void GhCompressReport(FILE * fp) {
+	for (int i = 0; i < SENSORS; i++) {
+		fprintf(fp, "Compress %-11s %8ld points in, %7ld out (%.1lf:1) within %.2lf\n",
+			compnames[i], csensors[i].in, csensors[i].out,
+			csensors[i].out > 0 ? (double) csensors[i].in / csensors[i].out : 0.0, csensors[i].err);
+	}
+}
+
+/** Loads a compressed log
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the file
+ * @param series receives the archived points of each sensor
+ * @return 1 if successful, 0 if the file is missing or not a compressed log
+ */
+int GhCompressLoad(const char * fname, compseries_s series[SENSORS]) {
+	char line[COMPLINESZ];
+	long cap[SENSORS] = {0}, t;
+	int version, heartbeat, mode[SENSORS], i, q;
+	double err, v;
+	compseries_s * s;
+	FILE * fp;
+
+	memset(series, 0, SENSORS * sizeof(compseries_s));
+	fp = fopen(fname, "r");
+	if (fp == NULL) {
+		return 0;
+	}
+	if (fgets(line, sizeof(line), fp) == NULL
+			|| sscanf(line, "#ghcompress,%d,%d,%d,%lf,%d,%lf,%d,%lf", &version, &heartbeat,
+				&mode[0], &err, &mode[1], &err, &mode[2], &err) != 8 || version != COMPVERSION) {
+		fclose(fp);
+		return 0;
+	}
+	for (i = 0; i < SENSORS; i++) {
+		series[i].mode = mode[i];
+	}
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (sscanf(line, "%ld,%d,%lf,%d", &t, &i, &v, &q) != 4 || i < 0 || i >= SENSORS) {
+			// A later header from appending to the file, or damage
+			continue;
+		}
+		s = &series[i];
+		if (s->n == cap[i]) {
+			cap[i] = cap[i] ? cap[i] * 2 : 1024;
+			s->t = realloc(s->t, cap[i] * sizeof(time_t));
+			s->v = realloc(s->v, cap[i] * sizeof(double));
+			s->q = realloc(s->q, cap[i] * sizeof(quality_e));
+			if (s->t == NULL || s->v == NULL || s->q == NULL) {
+				fclose(fp);
+				return 0;
+			}
+		}
+		s->t[s->n] = (time_t) t;
+		s->v[s->n] = v;
+		s->q[s->n] = (quality_e) q;
+		s->n++;
+	}
+	fclose(fp);
+	return 1;
+}
+
+/** Rebuilds the value of a sensor at a time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param s archived points of the sensor
+ * @param t time
+ * @param quality receives the quality of the archived point at or before t
+ * @return interpolated (COMPSDT) or held (COMPDEADBAND) value
+ */
+double GhCompressValue(const compseries_s * s, time_t t, quality_e * quality) {
+	long lo = 0, hi, mid;
+	double f;
+
+	if (s->n == 0) {
+		*quality = QBAD;
+		return 0.0;
+	}
+	// Last point at or before t
+	hi = s->n - 1;
+	if (t < s->t[0]) {
+		*quality = s->q[0];
+		return s->v[0];
+	}
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (s->t[mid] <= t) {
+			lo = mid;
+		}
+		else {
+			hi = mid - 1;
+		}
+	}
+	*quality = s->q[lo];
+	if (s->mode != COMPSDT || lo + 1 >= s->n || s->q[lo] != QGOOD || s->q[lo + 1] != QGOOD
+			|| s->t[lo + 1] == s->t[lo]) {
+		return s->v[lo];
+	}
+	f = (double)(t - s->t[lo]) / (double)(s->t[lo + 1] - s->t[lo]);
+	return s->v[lo] + f * (s->v[lo + 1] - s->v[lo]);
+}
+
+/** Rebuilds a full reading at a time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param series archived points of each sensor
+ * @param t time
+ * @return reading with rtime t
+ */
+reading_s GhCompressReading(const compseries_s series[SENSORS], time_t t) {
+	reading_s rdata = {0};
+	rdata.rtime = t;
+	rdata.temperature = GhCompressValue(&series[TEMPERATURE], t, &rdata.quality[TEMPERATURE]);
+	rdata.humidity = GhCompressValue(&series[HUMIDITY], t, &rdata.quality[HUMIDITY]);
+	rdata.pressure = GhCompressValue(&series[PRESSURE], t, &rdata.quality[PRESSURE]);
+	return rdata;
+}
+
+/** Gets the first and last time any sensor has a point
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param series archived points of each sensor
+ * @param first receives the earliest time, 0 if there are no points
+ * @param last receives the latest time
+ */
+void GhCompressSpan(const compseries_s series[SENSORS], time_t * first, time_t * last) {
+	*first = *last = 0;
+	for (int i = 0; i < SENSORS; i++) {
+		if (series[i].n > 0) {
+			*first = (*first == 0 || series[i].t[0] < *first) ? series[i].t[0] : *first;
+			*last = series[i].t[series[i].n - 1] > *last ? series[i].t[series[i].n - 1] : *last;
+		}
+	}
+}
+
+/** Frees what GhCompressLoad allocated
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param series archived points of each sensor
+ */
+void GhCompressFree(compseries_s series[SENSORS]) {
+	for (int i = 0; i < SENSORS; i++) {
+		free(series[i].t);
+		free(series[i].v);
+		free(series[i].q);
+		series[i].n = 0;
+	}
+}
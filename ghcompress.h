@@ -0,0 +1,64 @@
+/** Reading log compression constants, structures, function prototypes
+ * A compressed log holds, per sensor, only the points needed to rebuild
+ * the series within a fixed error: a header line
+ * "#ghcompress,1,heartbeat,mode,error,mode,error,mode,error" then rows
+ * "rtime,sensor,value,quality".
+ * @version ghcompress.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHCOMPRESS_H
+#define GHCOMPRESS_H
+
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define COMPSDT 0               // swinging door, rebuilt by linear interpolation
+#define COMPDEADBAND 1          // deadband, rebuilt by holding the last point
+#define COMPTERR 0.2            // C a rebuilt temperature may be off
+#define COMPHERR 0.5            // %
+#define COMPPERR 0.3            // hPa
+#define COMPHEARTBEAT 900       // seconds between points of a flat series
+#define COMPVERSION 1
+#define COMPLOG "ghdata.cmp"
+#define VIRTCOMPLOG "ghvirt.cmp"    // compressed log of a virtual run
+#define COMPLINESZ 128
+
+// Structures ##########################################
+typedef struct compsensor {
+	int mode;
+	double err;
+	int anchored;           // an archived point exists
+	time_t ta;              // last archived point
+	double va;
+	int pending;            // a point follows the archived one
+	time_t tp;              // latest point, not archived yet
+	double vp;
+	double upper;           // swinging door slopes from the archived point
+	double lower;
+	long in;
+	long out;
+}compsensor_s;
+
+typedef struct compseries {
+	int mode;
+	long n;
+	time_t * t;
+	double * v;
+	quality_e * q;
+}compseries_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+// Writer
+int GhCompressOpen(const char * fname, int mode, const double err[SENSORS], int heartbeat);
+void GhCompressAdd(reading_s rdata);
+void GhCompressClose(void);
+void GhCompressReport(FILE * fp);
+// Reader
+int GhCompressLoad(const char * fname, compseries_s series[SENSORS]);
+double GhCompressValue(const compseries_s * s, time_t t, quality_e * quality);
+reading_s GhCompressReading(const compseries_s series[SENSORS], time_t t);
+void GhCompressSpan(const compseries_s series[SENSORS], time_t * first, time_t * last);
+void GhCompressFree(compseries_s series[SENSORS]);
+/// @endcond
+#endif
@@ -1,20 +1,32 @@
 #include "ghcontrol.h"
+#include "ghcrc.h"
 
 //Constants
-const char alarmnames[NALARMS][ALARMNMSZ] = {"No Alarms","High Temperature","Low Temperature","High Humidity","Low Humidity","High Pressure","Low Pressure"};
+const char alarmnames[NALARMS][ALARMNMSZ] = {"No Alarms","High Temperature","Low Temperature","High Humidity","Low Humidity","High Pressure","Low Pressure","Sensor Fault",
+	"Sensor Stuck","Rate of Change","Sensor Noisy","Sensor Drift"};
+static const ghsource_s * source;  // NULL reads the Sense HAT
+const char qualitynames[3][9] = {""," (stale)"," (bad)"};
+// One node per alarm code, so raising an alarm never allocates; per
+// thread, as ghsweep replays alarms on several threads at once
+static _Thread_local alarm_s alarmpool[NALARMS];
+static _Thread_local alarm_s * alarmfree;
+static _Thread_local int alarmpooled;
+static filter_s filter;         // quality filter history of GhGetReadingsMask
 
 
 // Setup #######################################################################
 
 /** Initializes srand, GhDisplayHeaders
- * @version 2020-03-12
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  */
 void GhControllerInit(void) {
-	srand((unsigned) time(NULL));
+	srand((unsigned) GhClockNow());
 	GhDisplayHeader("Braydon Giallombardo");
 	#if SENSEHAT
-        wiringPiSetup();
+        if (ShGetBus()->hardware) {
+            wiringPiSetup();
+        }
         ShInit();
     #endif
 }
@@ -31,22 +43,23 @@ int GhGetRandom(int upperBound, int lowerBound) {
 }
 
 /** Induces a delay in milliseconds
- * @version 2020-03-12
+ * Sleeps on the controller clock, a virtual clock returns at once.
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param milliseconds integer that represents the delay time in milliseconds
  */
 void GhDelay(int milliseconds) {
-	// Variables
-	long wait;
-	clock_t now, start;
-
-	wait = milliseconds * (CLOCKS_PER_SEC/1000);
-	start = clock();
-	now = start;
+	GhClockSleep(milliseconds);
+}
 
-	while( (now-start) < wait) {
-		now = clock();
-	}
+/** Selects where readings come from
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param nsource source to read, NULL for the Sense HAT (or its simulated
+ * bus), a plant must be initialized first
+ */
+void GhSetSource(const ghsource_s * nsource) {
+	source = nsource;
 }
 
 // Displays #######################################################################
@@ -66,7 +79,10 @@ void GhDisplayHeader(const char * sname) {
  * @param rdata object of the structure readings named rdata
  */
 void GhDisplayReadings(reading_s rdata) {
-	fprintf(stdout,"\n%sReadings	 T: %3.1lfC    H: %.0lf%%  P: %5.1lfmb", ctime(&rdata.rtime), rdata.temperature, rdata.humidity, rdata.pressure);
+	fprintf(stdout,"\n%sReadings	 T: %3.1lfC%s    H: %.0lf%%%s  P: %5.1lfmb%s", ctime(&rdata.rtime),
+		rdata.temperature, qualitynames[rdata.quality[TEMPERATURE]],
+		rdata.humidity, qualitynames[rdata.quality[HUMIDITY]],
+		rdata.pressure, qualitynames[rdata.quality[PRESSURE]]);
 }
 
 /** Displays current setpoints
@@ -120,18 +136,17 @@ void GhDisplayAll(reading_s rd, setpoint_s sd) {
 }
 
 /* Display current state of alarms
- * @version 2020-03-06
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param alarm Object of alarm_s
  */
 void GhDisplayAlarms(alarm_s * head) {
 	alarm_s * cur;
-	cur = head;
 	fprintf(stdout, "Alarms\n");
-	while (cur = cur->next) {
-        /*if (cur->code != NOALARM) {*/
-           fprintf(stdout,"%s%s", cur->code, ctime(&cur->atime));
-
+	for (cur = head; cur != NULL; cur = cur->next) {
+		if (cur->code != NOALARM) {
+			fprintf(stdout,"%s %s", alarmnames[cur->code], ctime(&cur->atime));
+		}
 	}
 }
 
@@ -139,24 +154,48 @@ void GhDisplayAlarms(alarm_s * head) {
 // Sets ##########################################################################
 
 /** Controls heater and humidifier operation by comparing setpoints and sensor readings
- * @version 2020-03-12
+ * An output whose sensor is bad is switched off rather than driven blind.
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param target object of the structure setpoints named target
  * @param rdata object of the structure readings named rdata
  * @return cset - object of controls that determines the toggle of the heater and humififier
  */
 control_s GhSetControls(setpoint_s target, reading_s rdata) {
-	control_s cset;
-	if (rdata.temperature < target.temperature) {
+	control_s none = {0};
+	return GhSetControlsBand(target, rdata, none, 0.0, 0.0);
+}
+
+/** Controls heater and humidifier operation with a deadband below each setpoint
+ * An output switches on below setpoint - band, off at the setpoint and
+ * otherwise keeps its previous state. A band of 0 behaves like GhSetControls.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param target object of the structure setpoints named target
+ * @param rdata object of the structure readings named rdata
+ * @param prev controls of the previous cycle
+ * @param tband temperature deadband in C
+ * @param hband humidity deadband in %
+ * @return cset - object of controls that determines the toggle of the heater and humififier
+ */
+control_s GhSetControlsBand(setpoint_s target, reading_s rdata, control_s prev, double tband, double hband) {
+	control_s cset = prev;
+	if (rdata.quality[TEMPERATURE] == QBAD) {
+		cset.heater = OFF;
+	}
+	else if (rdata.temperature < target.temperature - tband) {
 		cset.heater = ON;
 	}
-	else {
+	else if (rdata.temperature >= target.temperature) {
 		cset.heater = OFF;
 	}
-	if (rdata.humidity < target.humidity) {
+	if (rdata.quality[HUMIDITY] == QBAD) {
+		cset.humidifier = OFF;
+	}
+	else if (rdata.humidity < target.humidity - hband) {
 		cset.humidifier = ON;
 	}
-	else {
+	else if (rdata.humidity >= target.humidity) {
 		cset.humidifier = OFF;
 	}
 	return cset;
@@ -169,9 +208,8 @@ control_s GhSetControls(setpoint_s target, reading_s rdata) {
  */
 setpoint_s GhSetSetpoints(void) {
  	setpoint_s cpoints = {0};
- 	cpoints = GhRetrieveSetpoints("setpoints.dat");
 
- 	if (cpoints.temperature == 0) {
+ 	if (!GhRetrieveSetpoints("setpoints.dat", &cpoints)) {
  		cpoints.temperature = STEMP;
  		cpoints.humidity = SHUMID;
  		GhSaveSetpoints("setpoints.dat", cpoints);
@@ -197,34 +235,52 @@ alarmlimit_s GhSetAlarmLimits(void) {
 }
 
 /** Sets alarms
- * @version 2020-04-06
+ * Limits are only checked against usable readings, a bad sensor keeps its
+ * alarms as they were and raises SFAULT instead.
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param calarm[NALARM]
  * @param alarmpt
  * @param rdata
  */
 alarm_s * GhSetAlarms(alarm_s * head, alarmlimit_s alarmpt, reading_s rdata) {
-	for(int i=0; i<NALARMS;i++) {
-        head->code = NOALARM;
+	int bad = -1;
+
+	for(int i=0; i<SENSORS;i++) {
+		if (rdata.quality[i] == QBAD && bad < 0) {
+			bad = i;
+		}
+	}
+	if (rdata.quality[TEMPERATURE] != QBAD) {
+		if (rdata.temperature >= alarmpt.hight) {
+			GhSetOneAlarm(HTEMP,rdata.rtime,rdata.temperature,head);
+		}
+		else {
+			head = GhClearOneAlarm(HTEMP, head);
+		}
 	}
-	if (rdata.temperature >= alarmpt.hight) {
-		GhSetOneAlarm(HTEMP,rdata.rtime,rdata.temperature,head);
+	if (rdata.quality[HUMIDITY] != QBAD) {
+		if (rdata.humidity >= alarmpt.highh) {
+			GhSetOneAlarm(HHUMID,rdata.rtime,rdata.humidity,head);
+		}
+		else {
+			head = GhClearOneAlarm(HHUMID, head);
+		}
 	}
-    else {
-		head = GhClearOneAlarm(HTEMP, head);
+	if (rdata.quality[PRESSURE] != QBAD) {
+		if (rdata.pressure >= alarmpt.highp) {
+			GhSetOneAlarm(HPRESS,rdata.rtime,rdata.pressure,head);
+		}
+		else {
+			head = GhClearOneAlarm(HPRESS, head);
+		}
 	}
-	if (rdata.humidity >= alarmpt.highh) {
-		GhSetOneAlarm(HHUMID,rdata.rtime,rdata.humidity,head);
+	if (bad >= 0) {
+		GhSetOneAlarm(SFAULT,rdata.rtime,bad,head);
 	}
-    else {
-		head = GhClearOneAlarm(HHUMID, head);
+	else {
+		head = GhClearOneAlarm(SFAULT, head);
 	}
-    if (rdata.pressure >= alarmpt.highp) {
-		GhSetOneAlarm(HPRESS,rdata.rtime,rdata.pressure,head);
-    }
-    else {
-		head = GhClearOneAlarm(HPRESS, head);
-    }
     return head;
 }
 
@@ -245,11 +301,11 @@ int GhSetOneAlarm(alarm_e code, time_t atime, double value, alarm_s * head) {
             last = cur;
             cur = cur->next;
 		}
-		cur = (alarm_s *)calloc(1, sizeof(alarm_s));
-		last->next = cur;
+		cur = GhAlarmNew();
 		if(cur == NULL) {
             return 0;
 		}
+		last->next = cur;
 	}
 	cur->code = code;
 	cur->atime = atime;
@@ -277,7 +333,7 @@ alarm_s * GhClearOneAlarm(alarm_e code, alarm_s * head) {
   if(cur-> code == code && cur->next != NULL)
   {
       head = cur->next;
-      free(cur);
+      GhAlarmDelete(cur);
       return head;
   }
 
@@ -285,8 +341,10 @@ alarm_s * GhClearOneAlarm(alarm_e code, alarm_s * head) {
   {
       if(cur->code == code)
       {
+          // Codes are unique, and a pooled node's next is reused at once
           last->next = cur->next;
-          free(cur);
+          GhAlarmDelete(cur);
+          return head;
       }
       last = cur;
       cur = cur->next;
@@ -294,49 +352,157 @@ alarm_s * GhClearOneAlarm(alarm_e code, alarm_s * head) {
   return head;
 }
 
+/** Takes a cleared alarm node from the pool
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return node, from calloc only if the pool is exhausted, NULL on error
+ */
+alarm_s * GhAlarmNew(void) {
+	alarm_s * cur;
+
+	if (!alarmpooled) {
+		for (int i = 0; i < NALARMS; i++) {
+			alarmpool[i].next = alarmfree;
+			alarmfree = &alarmpool[i];
+		}
+		alarmpooled = 1;
+	}
+	if (alarmfree == NULL) {
+		return (alarm_s *) calloc(1, sizeof(alarm_s));
+	}
+	cur = alarmfree;
+	alarmfree = cur->next;
+	memset(cur, 0, sizeof(alarm_s));
+	return cur;
+}
+
+/** Returns an alarm node to the pool
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param cur node from GhAlarmNew on the same thread
+ */
+void GhAlarmDelete(alarm_s * cur) {
+	if (cur >= alarmpool && cur < alarmpool + NALARMS) {
+		cur->next = alarmfree;
+		alarmfree = cur;
+	}
+	else {
+		free(cur);
+	}
+}
+
+/** Drives the actuators with the control outputs
+ * Only a source such as the plant simulator has actuators wired up, on
+ * the Sense HAT the outputs are displayed.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param ctrl object of the structure controls named ctrl
+ */
+void GhSetActuators(control_s ctrl) {
+	if (source != NULL) {
+		source->actuate(ctrl.heater, ctrl.humidifier);
+	}
+}
+
+/** Gets the set of active alarms
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param head alarm list
+ * @return bit (1 << code) set for every active alarm code
+ */
+unsigned int GhAlarmMask(alarm_s * head) {
+	unsigned int mask = 0;
+	for (alarm_s * cur = head; cur != NULL; cur = cur->next) {
+		if (cur->code != NOALARM) {
+			mask |= 1u << cur->code;
+		}
+	}
+	return mask;
+}
+
+/** Finds the active alarm with a code
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param head alarm list
+ * @param code alarm code
+ * @return the alarm, NULL if it is not set
+ */
+alarm_s * GhFindAlarm(alarm_s * head, alarm_e code) {
+	for (alarm_s * cur = head; cur != NULL; cur = cur->next) {
+		if (cur->code == code) {
+			return cur;
+		}
+	}
+	return NULL;
+}
+
 // Gets ##########################################################################
 
 /** Gets current temperature
- * @version 2020-03-12
+ * @version 2026-10-19
  * @author Braydon Giallombardo
+ * @param quality set to QGOOD, or QBAD if the sensor read failed
  * @return GhGetRandom of LSTEMP to USTEMP, or 25.0
  */
-double GhGetTemperature(void) {
+double GhGetTemperature(quality_e * quality) {
+	*quality = QGOOD;
+	if (source != NULL) {
+		return source->temperature();
+	}
 	#if SIMTEMPERATURE
 		return GhGetRandom(USTEMP, LSTEMP);
 	#else
         ht221sData_s ct = {0};
         ct = ShGetHT221SData();
+		if (ct.status != SHOK) {
+			*quality = QBAD;
+		}
 		return ct.temperature;
 	#endif
 }
 
 /** Gets current humidity
- * @version 2020-03-12
+ * @version 2026-10-19
  * @author Braydon Giallombardo
+ * @param quality set to QGOOD, or QBAD if the sensor read failed
  * @return GhGetRandom of LSHUMID to USHUMID, or 55.0
  */
-double GhGetHumidity(void) {
+double GhGetHumidity(quality_e * quality) {
+	*quality = QGOOD;
+	if (source != NULL) {
+		return source->humidity();
+	}
 	#if SIMHUMIDITY
 		return GhGetRandom(USHUMID, LSHUMID);
 	#else
         ht221sData_s ct = {0};
         ct = ShGetHT221SData();
+		if (ct.status != SHOK) {
+			*quality = QBAD;
+		}
 		return ct.humidity;
 	#endif
 }
 
 /** Gets current pressure
- * @version 2020-03-12
+ * @version 2026-10-19
  * @author Braydon Giallombardo
+ * @param quality set to QGOOD, or QBAD if the sensor read failed
  * @return GhGetRandom of LSPRESS to USPRESS, or 1013.0
  */
-double GhGetPressure(void) {
+double GhGetPressure(quality_e * quality) {
+	*quality = QGOOD;
+	if (source != NULL) {
+		return source->pressure();
+	}
 	#if SIMPRESSURE
 		return GhGetRandom(USPRESS, LSPRESS);
 	#else
         lps25hData_s ct = {0};
         ct = ShGetLPS25HData();
+		if (ct.status != SHOK) {
+			*quality = QBAD;
+		}
 		return ct.pressure;
 	#endif
 }
@@ -353,92 +519,239 @@ void GhGetControls(void) {}
  */
 void GhGetSetpoints(void) {}
 
+/** Substitutes the last good value for a failed reading
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param value fresh reading
+ * @param quality quality of value, downgraded to QSTALE or QBAD on failure
+ * @param last last good value of this sensor
+ * @param lastgood time of the last good value, 0 if there never was one
+ * @param now time of the reading
+ * @return value to report
+ */
+static double GhQualify(double value, quality_e * quality, double * last, time_t * lastgood, time_t now) {
+	if (*quality == QGOOD) {
+		*last = value;
+		*lastgood = now;
+		return value;
+	}
+	if (*lastgood != 0 && now - *lastgood <= GHSTALEMAX) {
+		*quality = QSTALE;
+	}
+	return *last;
+}
+
 /** Displays current sensor readings
- * @version 2020-03-12
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @return now - object of readings containing the values of each reading
  */
 reading_s GhGetReadings(void) {
-	reading_s now = {0};
-	now.rtime = time(NULL);
-	now.temperature = GhGetTemperature();
-	now.humidity = GhGetHumidity();
-	now.pressure = GhGetPressure();
+	return GhGetReadingsMask((1u << SENSORS) - 1);
+}
+
+/** Gets some of the current readings, the others keep their last value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param mask bit TEMPERATURE, HUMIDITY or PRESSURE set for each sensor to read
+ * @return readings with rtime set to now
+ */
+reading_s GhGetReadingsMask(unsigned int mask) {
+	reading_s now = filter.prev;
+	now.rtime = GhClockNow();
+	if (source != NULL) {
+		source->step(now.rtime);
+	}
+	if (mask & (1u << TEMPERATURE)) {
+		now.temperature = GhGetTemperature(&now.quality[TEMPERATURE]);
+		now.temperature = GhQualify(now.temperature, &now.quality[TEMPERATURE], &filter.last.temperature, &filter.lastgood[TEMPERATURE], now.rtime);
+	}
+	if (mask & (1u << HUMIDITY)) {
+		now.humidity = GhGetHumidity(&now.quality[HUMIDITY]);
+		now.humidity = GhQualify(now.humidity, &now.quality[HUMIDITY], &filter.last.humidity, &filter.lastgood[HUMIDITY], now.rtime);
+	}
+	if (mask & (1u << PRESSURE)) {
+		now.pressure = GhGetPressure(&now.quality[PRESSURE]);
+		now.pressure = GhQualify(now.pressure, &now.quality[PRESSURE], &filter.last.pressure, &filter.lastgood[PRESSURE], now.rtime);
+	}
+	filter.prev = now;
 	return now;
 }
 
+/** Gets the quality filter history, for a checkpoint
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return last good values and times, and the previous readings
+ */
+filter_s GhGetFilter(void) {
+	return filter;
+}
+
+/** Restores the quality filter history from a checkpoint
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param nfilter history from GhGetFilter
+ */
+void GhSetFilter(filter_s nfilter) {
+	filter = nfilter;
+}
+
 // Data Logs ##########################################################################
 
+/** Writes one GhLogData row
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to write to
+ * @param ghdata object of the structure readings named ghdata
+ */
+void GhWriteLogRow(FILE * fp, reading_s ghdata) {
+	char ltime[25];
+
+	// Set characters in array
+	strcpy(ltime, ctime(&ghdata.rtime));
+	ltime[3] = ',';
+	ltime[7] = ',';
+	ltime[10] = ',';
+	ltime[19] = ',';
+	// Write to fp stream
+	fprintf(fp, "%.24s,%3.1lf,%3.1lf,%5.1lf\n", ltime, ghdata.temperature, ghdata.humidity, ghdata.pressure);
+}
+
 /** Log of data from reading object "ghdata"
- * @version 2020-03-12
+ * The file stays open between calls. Rows are flushed every call on the
+ * real clock and left to stdio buffering on the virtual clock.
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param *fname Name of the file
  * @param ghdata object of the structure readings named ghdata
  * @return if error opening: 0, else: 1
  */
 int GhLogData(char * fname, reading_s ghdata) {
-	FILE * fp;
-	char ltime[25];
-	fp = fopen(fname, "a");
+	static FILE * fp = NULL;
+	static char lname[FILENAME_MAX] = "";
+
+	if (fp == NULL || strcmp(lname, fname) != 0) {
+		if (fp != NULL) {
+			fclose(fp);
+		}
+		fp = fopen(fname, "a");
+		strncpy(lname, fname, sizeof(lname) - 1);
+	}
 
 	if (fp == NULL) {
 		fprintf(stdout,"\nCan't open file, data not retrieved!\n");
 		return 0;
 	}
 	else {
-		// Set characters in array
-		strcpy(ltime, ctime(&ghdata.rtime));
-		ltime[3] = ',';
-		ltime[7] = ',';
-		ltime[10] = ',';
-		ltime[19] = ',';
-		// Write to fp stream
-		fprintf(fp, "%.24s,%3.1lf,%3.1lf,%5.1lf\n", ltime, ghdata.temperature, ghdata.humidity, ghdata.pressure);
-		fclose(fp);
+		GhWriteLogRow(fp, ghdata);
+		if (!GhClockIsVirtual()) {
+			fflush(fp);
+		}
 		return 1;
 	}
 }
 
-/** Save setpoint data as binary
- * @version 2020-03-12
+/** Parses one row written by GhLogData
+ * The ctime() based time stamp is read as UTC civil time, so rtime is only
+ * meaningful for ordering and differences between rows.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param line row such as "Thu,Mar,12,14:05:33,2020,25.0,55.0,1013.2"
+ * @param rdata receives the reading, every quality QGOOD
+ * @return 1 if the row parsed, 0 if it is malformed
+ */
+int GhParseLogRow(const char * line, reading_s * rdata) {
+	static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+	char wday[4], mon[4];
+	int day, hh, mm, ss, year, m;
+	const char * mp;
+	long long days;
+
+	if (sscanf(line, "%3[A-Za-z],%3[A-Za-z],%d,%d:%d:%d,%d,%lf,%lf,%lf", wday, mon, &day, &hh, &mm, &ss,
+			&year, &rdata->temperature, &rdata->humidity, &rdata->pressure) != 10) {
+		return 0;
+	}
+	mp = strstr(months, mon);
+	if (mp == NULL || (mp - months) % 3 != 0 || day < 1 || day > 31) {
+		return 0;
+	}
+	// Days from civil (proleptic Gregorian), March based year
+	m = (int)(mp - months) / 3 + 1;
+	year -= m <= 2;
+	days = 365LL * year + year / 4 - year / 100 + year / 400
+		+ (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + day - 1 - 719468;
+	rdata->rtime = (time_t)(days * 86400 + hh * 3600 + mm * 60 + ss);
+	for (int i = 0; i < SENSORS; i++) {
+		rdata->quality[i] = QGOOD;
+	}
+	return 1;
+}
+
+/** Save setpoint data as binary, behind a version and CRC header
+ * The file is written beside the old one and renamed over it, so a reader
+ * or a crash never sees half of it.
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param *fname Name of the file
  * @param spts object of the structure setpoints named spts
  * @return if error opening: 0, else: 1
  */
 int GhSaveSetpoints(char * fname, setpoint_s spts){
+	setpointfile_s sf = {0};
+	char tname[FILENAME_MAX];
 	FILE * fp;
-	fp = fopen(fname, "w");
-
-  if (fp == NULL) {
-  	fprintf(stdout,"\nCan't open file, data not retrieved!\n");
-  	return 0;
-  }
-	else {
-		fwrite(&spts, sizeof(setpoint_s), 1, fp);
-		fclose(fp);
-		return 1;
+	int ok;
+
+	sf.magic = SPTSMAGIC;
+	sf.version = SPTSVERSION;
+	sf.size = sizeof(setpoint_s);
+	sf.spts = spts;
+	sf.crc = GhCrc32(0, &sf.spts, sizeof(setpoint_s));
+	snprintf(tname, sizeof(tname), "%s.tmp", fname);
+	fp = fopen(tname, "w");
+	if (fp == NULL) {
+		fprintf(stdout,"\nCan't open file, data not retrieved!\n");
+		return 0;
 	}
+	ok = fwrite(&sf, sizeof(setpointfile_s), 1, fp) == 1;
+	ok = fclose(fp) == 0 && ok;
+	if (!ok || rename(tname, fname) == -1) {
+		remove(tname);
+		return 0;
+	}
+	return 1;
 }
 
 /** Retrieves saved setpoints from file
- * @version 2020-03-12
+ * Both the versioned file and the bare setpoint_s of older releases are
+ * accepted.
+ * @version 2026-10-19
  * @author Braydon Giallombardo
  * @param *fname Name of the file
- * @return if error opening: 0, else: 1
+ * @param spts receives the setpoints, left alone on error
+ * @return 1 if retrieved, 0 if the file is missing or damaged
  */
-setpoint_s GhRetrieveSetpoints(char * fname){
-	setpoint_s spts = {0};
+int GhRetrieveSetpoints(char * fname, setpoint_s * spts){
+	setpointfile_s sf;
+	size_t n;
 	FILE * fp;
-	fp = fopen(fname, "r");
 
+	fp = fopen(fname, "r");
 	if (fp == NULL) {
 		fprintf(stdout, "\nCan't open file, data not retrieved!\n");
-		return spts;
-  }
-	else {
-		fread(&spts, sizeof(setpoint_s), 1, fp);
-		fclose(fp);
-		return spts;
+		return 0;
+	}
+	n = fread(&sf, 1, sizeof(setpointfile_s), fp);
+	fclose(fp);
+	if (n == sizeof(setpoint_s)) {
+		memcpy(spts, &sf, sizeof(setpoint_s));
+		return 1;
+	}
+	if (n == sizeof(setpointfile_s) && sf.magic == SPTSMAGIC && sf.version == SPTSVERSION
+			&& sf.size == sizeof(setpoint_s) && sf.crc == GhCrc32(0, &sf.spts, sizeof(setpoint_s))) {
+		*spts = sf.spts;
+		return 1;
 	}
+	fprintf(stdout, "\n%s is damaged or from a newer version, setpoints not retrieved!\n", fname);
+	return 0;
 }
@@ -6,6 +6,7 @@
 #include <time.h>
 #include <string.h>
 #include "pisensehat.h"
+#include "ghclock.h"
 #include <wiringPi.h>
 
 // Constants ##############################################
@@ -22,6 +23,8 @@
 #define LSPRESS 985
 #define STEMP 25.0
 #define SHUMID 55.0
+#define TBAND 0.0 // Heater deadband below the temperature setpoint
+#define HBAND 0.0 // Humidifier deadband below the humidity setpoint
 #define LOWERATEMP 10
 #define UPPERATEMP 30
 #define LOWERAHUMID 25
@@ -35,17 +38,24 @@
 #define TBAR 7
 #define HBAR 5
 #define PBAR 3
-#define NALARMS 7
+#define NALARMS 12
 #define ALARMNMSZ 18
 #define SENSEHAT 1
 #define SIMULATE 0 // Toggle Simulation
 #define SIMTEMPERATURE 0 // Toggle TEMPERATURE Simulation
 #define SIMHUMIDITY 0 // Toggle HUMIDITY Simulation
 #define SIMPRESSURE 0 // Toggle PRESSURE Simulation
+#define SPTSMAGIC 0x50534847 // "GHSP" at the start of setpoints.dat
+#define SPTSVERSION 1
+#define GHSOCKET "ghc.sock" // Status socket for local clients
+#define GHLOG "ghdata.txt" // Log of the running controller
+#define VIRTLOG "ghvirt.txt" // Log of a virtual run, kept apart from the real one
+#define GHSTALEMAX 30 // Seconds a last good reading may stand in for a failed one
 
 
 // Enumerated Types
-typedef enum { NOALARM,HTEMP,LTEMP,HHUMID,LHUMID,HPRESS,LPRESS }alarm_e;
+typedef enum { NOALARM,HTEMP,LTEMP,HHUMID,LHUMID,HPRESS,LPRESS,SFAULT,SSTUCK,SRATE,SNOISE,SDRIFT }alarm_e;
+typedef enum { QGOOD,QSTALE,QBAD }quality_e;
 
 // Structures ##########################################
 typedef struct readings {
@@ -53,6 +63,7 @@ typedef struct readings {
   double temperature;
   double humidity;
   double pressure;
+  quality_e quality[SENSORS];
 }reading_s;
 
 typedef struct setpoints {
@@ -81,12 +92,47 @@ typedef struct alarms {
     struct alarms * next;
 }alarm_s;
 
+typedef struct filter {
+	reading_s last;         // last good value of each sensor
+	reading_s prev;         // previous readings, kept for sensors not read
+	time_t lastgood[SENSORS];
+}filter_s;
+
+typedef struct setpointfile {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;          // sizeof(setpoint_s) when it was written
+	uint32_t crc;           // of spts
+	setpoint_s spts;
+}setpointfile_s;
+
+// A source of readings other than the Sense HAT that also takes the
+// control outputs, such as the greenhouse plant simulator
+typedef struct ghsource {
+	void (*step)(time_t now);
+	void (*actuate)(int heater, int humidifier);
+	double (*temperature)(void);
+	double (*humidity)(void);
+	double (*pressure)(void);
+}ghsource_s;
+
+typedef struct ghstate {
+	reading_s creadings;
+	control_s ctrl;
+	setpoint_s spts;
+	alarmlimit_s alimits;
+	alarm_s * arecord;
+}ghstate_s;
+
+extern const char alarmnames[NALARMS][ALARMNMSZ];
+
 /// @cond INTERNAL
 // Function Prototypes #################################
 // Setup
 void GhControllerInit(void);
 int GhGetRandom(int upperBound, int lowerBound);
 void GhDelay(int milliseconds);
+void GhSetSource(const ghsource_s * nsource);
 // Displays
 void GhDisplayHeader(const char * sname);
 void GhDisplayReadings(reading_s rdata);
@@ -96,22 +142,33 @@ void GhDisplayAll(reading_s rd, setpoint_s sd);
 void GhDisplayAlarms(alarm_s * head);
 // Sets
 control_s GhSetControls(setpoint_s target, reading_s rdata);
+control_s GhSetControlsBand(setpoint_s target, reading_s rdata, control_s prev, double tband, double hband);
 setpoint_s GhSetSetpoints(void);
 alarmlimit_s GhSetAlarmLimits(void);
 alarm_s * GhSetAlarms(alarm_s * head, alarmlimit_s alarmpt, reading_s rdata);
 int GhSetOneAlarm(alarm_e code, time_t atime, double value, alarm_s * head);
 alarm_s * GhClearOneAlarm(alarm_e code, alarm_s * head);
+alarm_s * GhAlarmNew(void);
+void GhAlarmDelete(alarm_s * cur);
+unsigned int GhAlarmMask(alarm_s * head);
+alarm_s * GhFindAlarm(alarm_s * head, alarm_e code);
+void GhSetActuators(control_s ctrl);
 // Gets
-double GhGetTemperature(void);
-double GhGetHumidity(void);
-double GhGetPressure(void);
+double GhGetTemperature(quality_e * quality);
+double GhGetHumidity(quality_e * quality);
+double GhGetPressure(quality_e * quality);
 void GhGetSetpoints(void);
 void GhGetControls(void);
 reading_s GhGetReadings(void);
+reading_s GhGetReadingsMask(unsigned int mask);
 // Data Logs
 int GhLogData(char * fname, reading_s ghdata);
+void GhWriteLogRow(FILE * fp, reading_s ghdata);
+int GhParseLogRow(const char * line, reading_s * rdata);
 int GhSaveSetpoints(char * fname, setpoint_s spts);
-setpoint_s GhRetrieveSetpoints(char * fname);
+int GhRetrieveSetpoints(char * fname, setpoint_s * spts);
+filter_s GhGetFilter(void);
+void GhSetFilter(filter_s nfilter);
 /// @cond EXTERNAL
 
 #endif
@@ -0,0 +1,44 @@
+/** CRC-32 (IEEE 802.3, reflected, as used by zlib) for on-disk records
+ * @version ghcrc.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include "ghcrc.h"
+
+static uint32_t crctable[256];
+
+/** Builds the byte table on first use
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhCrcTable(void) {
+	uint32_t c;
+
+	for (uint32_t n = 0; n < 256; n++) {
+		c = n;
+		for (int k = 0; k < 8; k++) {
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		}
+		crctable[n] = c;
+	}
+}
+
+/** Updates a CRC-32 with more bytes
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param crc 0 to start, or the value returned for the previous bytes
+ * @param buf bytes
+ * @param len number of bytes
+ * @return CRC-32 of everything so far
+ */
+uint32_t GhCrc32(uint32_t crc, const void * buf, size_t len) {
+	const uint8_t * p = buf;
+
+	if (crctable[1] == 0) {
+		GhCrcTable();
+	}
+	crc = ~crc;
+	while (len--) {
+		crc = crctable[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
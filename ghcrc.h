@@ -0,0 +1,15 @@
+/** CRC-32 function prototypes
+ * @version ghcrc.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHCRC_H
+#define GHCRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+uint32_t GhCrc32(uint32_t crc, const void * buf, size_t len);
+/// @endcond
+#endif
@@ -0,0 +1,433 @@
+/** Event loop functions
+ * Multiplexes periodic timers, worker thread notifications, file change
+ * watches and socket/device descriptors over a single epoll descriptor so
+ * the controller sleeps until there is real work to do.
+ * @version ghevent.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <libgen.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include "ghevent.h"
+
+// Handler kinds
+enum { GHEV_FD, GHEV_TIMER, GHEV_NOTIFY, GHEV_INOTIFY, GHEV_SIGNAL };
+
+typedef struct ghwatch {
+	int wd;
+	char name[GHWATCHNMSZ];
+	ghhandler_f fn;
+	void * ctx;
+}ghwatch_s;
+
+static int epfd = -1;           // epoll file handle
+static int infd = -1;           // inotify file handle
+static int running;             // cleared by GhEventStop
+static ghhandler_s * handlers;  // indexed by the slot stored in epoll data
+static int nhandlers;
+static ghwatch_s watches[GHMAXWATCHES];
+
+/** Finds a free handler slot, growing the table when it is full
+ * Slots are addressed by index so the table may move when it grows.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return index of an unused handler, -1 if memory ran out
+ */
+static int GhEventSlot(void) {
+	ghhandler_s * grown;
+	int n;
+
+	for (int i = 0; i < nhandlers; i++) {
+		if (handlers[i].fn == NULL) {
+			return i;
+		}
+	}
+	n = nhandlers ? nhandlers * 2 : GHHANDLERSINIT;
+	grown = realloc(handlers, n * sizeof(ghhandler_s));
+	if (grown == NULL) {
+		return -1;
+	}
+	memset(grown + nhandlers, 0, (n - nhandlers) * sizeof(ghhandler_s));
+	handlers = grown;
+	nhandlers = n;
+	return GhEventSlot();
+}
+
+/** Registers a descriptor of a given kind with epoll
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful, 0 on error
+ */
+static int GhEventAdd(int fd, int kind, uint32_t events, ghhandler_f fn, void * ctx) {
+	struct epoll_event ev = {0};
+	ghhandler_s * h;
+	int slot;
+
+	if (fd < 0 || fn == NULL || (slot = GhEventSlot()) < 0) {
+		return 0;
+	}
+	h = &handlers[slot];
+	h->fd = fd;
+	h->kind = kind;
+	h->fn = fn;
+	h->ctx = ctx;
+	ev.events = events;
+	// The descriptor rides along so events for a recycled slot are dropped
+	ev.data.u64 = (uint64_t)(uint32_t) fd << 32 | (uint32_t) slot;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		perror("Error (call to 'epoll_ctl')");
+		h->fn = NULL;
+		return 0;
+	}
+	return 1;
+}
+
+/** Placeholder handler for descriptors the loop services itself
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhEventNone(int fd, uint32_t events, void * ctx) {}
+
+/** Creates the epoll instance
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful, 0 on error
+ */
+int GhEventInit(void) {
+	free(handlers);
+	handlers = NULL;
+	nhandlers = 0;
+	memset(watches, 0, sizeof(watches));
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd == -1) {
+		perror("Error (call to 'epoll_create1')");
+		return 0;
+	}
+	return 1;
+}
+
+/** Closes every descriptor the event loop created
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhEventExit(void) {
+	for (int i = 0; i < nhandlers; i++) {
+		if (handlers[i].fn != NULL && handlers[i].kind != GHEV_FD) {
+			close(handlers[i].fd);
+		}
+		handlers[i].fn = NULL;
+	}
+	if (epfd != -1) {
+		close(epfd);
+	}
+	epfd = -1;
+	infd = -1;
+}
+
+/** Watches a caller owned descriptor (socket, device, pipe)
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fd descriptor to watch
+ * @param events epoll event mask, usually EPOLLIN
+ * @param fn handler called when fd is ready
+ * @param ctx pointer handed back to fn
+ * @return 1 if successful, 0 on error
+ */
+int GhEventAddFd(int fd, uint32_t events, ghhandler_f fn, void * ctx) {
+	return GhEventAdd(fd, GHEV_FD, events, fn, ctx);
+}
+
+/** Stops watching a descriptor, the caller still owns it
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fd descriptor to forget
+ * @return 1 if successful, 0 if fd was not registered
+ */
+int GhEventRemoveFd(int fd) {
+	for (int i = 0; i < nhandlers; i++) {
+		if (handlers[i].fn != NULL && handlers[i].fd == fd) {
+			epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+			handlers[i].fn = NULL;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/** Creates a timerfd and registers it with the loop
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param milliseconds period of the timer, 0 creates a disarmed timer
+ * @param fn handler called on every expiry
+ * @param ctx pointer handed back to fn
+ * @return timer descriptor, -1 on error
+ */
+int GhEventAddTimer(int milliseconds, ghhandler_f fn, void * ctx) {
+	int tfd;
+
+	tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (tfd == -1) {
+		perror("Error (call to 'timerfd_create')");
+		return -1;
+	}
+	if (!GhEventAdd(tfd, GHEV_TIMER, EPOLLIN, fn, ctx)) {
+		close(tfd);
+		return -1;
+	}
+	GhEventSetTimer(tfd, milliseconds, 1);
+	return tfd;
+}
+
+/** Re-arms a timer created by GhEventAddTimer
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param tfd timer descriptor
+ * @param milliseconds time until the next expiry, 0 disarms the timer
+ * @param periodic non zero to repeat at the same interval
+ * @return 1 if successful, 0 on error
+ */
+int GhEventSetTimer(int tfd, int milliseconds, int periodic) {
+	struct itimerspec its = {0};
+
+	its.it_value.tv_sec = milliseconds / 1000;
+	its.it_value.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+	if (periodic) {
+		its.it_interval = its.it_value;
+	}
+	if (timerfd_settime(tfd, 0, &its, NULL) == -1) {
+		perror("Error (call to 'timerfd_settime')");
+		return 0;
+	}
+	return 1;
+}
+
+/** Gets the time left until a timer next expires
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param tfd timer descriptor
+ * @return milliseconds, -1 if the timer is disarmed or on error
+ */
+int GhEventTimerLeft(int tfd) {
+	struct itimerspec its;
+
+	if (timerfd_gettime(tfd, &its) == -1 || (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)) {
+		return -1;
+	}
+	return (int)(its.it_value.tv_sec * 1000 + its.it_value.tv_nsec / 1000000L);
+}
+
+/** Creates an eventfd other threads can use to wake the loop
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fn handler called in the loop thread after GhEventNotify
+ * @param ctx pointer handed back to fn
+ * @return event descriptor, -1 on error
+ */
+int GhEventAddNotify(ghhandler_f fn, void * ctx) {
+	int efd;
+
+	efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (efd == -1) {
+		perror("Error (call to 'eventfd')");
+		return -1;
+	}
+	if (!GhEventAdd(efd, GHEV_NOTIFY, EPOLLIN, fn, ctx)) {
+		close(efd);
+		return -1;
+	}
+	return efd;
+}
+
+/** Wakes the loop from any thread, safe to call from a signal handler
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param efd descriptor returned by GhEventAddNotify
+ * @return 1 if successful, 0 on error
+ */
+int GhEventNotify(int efd) {
+	uint64_t one = 1;
+	return write(efd, &one, sizeof(one)) == sizeof(one);
+}
+
+/** Calls a handler whenever a file is rewritten or replaced
+ * The parent directory is watched so editors that save through a
+ * rename are still noticed.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname path of the file to watch
+ * @param fn handler called after the file changes
+ * @param ctx pointer handed back to fn
+ * @return 1 if successful, 0 on error
+ */
+int GhEventWatchFile(const char * fname, ghhandler_f fn, void * ctx) {
+	char dpath[GHWATCHNMSZ], bpath[GHWATCHNMSZ];
+	ghwatch_s * w = NULL;
+
+	for (int i = 0; i < GHMAXWATCHES; i++) {
+		if (watches[i].fn == NULL) {
+			w = &watches[i];
+			break;
+		}
+	}
+	if (w == NULL || strlen(fname) >= GHWATCHNMSZ) {
+		return 0;
+	}
+	if (infd == -1) {
+		infd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (infd == -1) {
+			perror("Error (call to 'inotify_init1')");
+			return 0;
+		}
+		if (!GhEventAdd(infd, GHEV_INOTIFY, EPOLLIN, GhEventNone, NULL)) {
+			close(infd);
+			infd = -1;
+			return 0;
+		}
+	}
+	strcpy(dpath, fname);
+	strcpy(bpath, fname);
+	w->wd = inotify_add_watch(infd, dirname(dpath), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (w->wd == -1) {
+		perror("Error (call to 'inotify_add_watch')");
+		return 0;
+	}
+	strcpy(w->name, basename(bpath));
+	w->fn = fn;
+	w->ctx = ctx;
+	return 1;
+}
+
+/** Routes SIGINT, SIGTERM and SIGHUP through the loop
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fn handler called with the signal number in events
+ * @param ctx pointer handed back to fn
+ * @return 1 if successful, 0 on error
+ */
+int GhEventAddSignals(ghhandler_f fn, void * ctx) {
+	sigset_t mask;
+	int sfd;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGHUP);
+	sigprocmask(SIG_BLOCK, &mask, NULL);
+	sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (sfd == -1) {
+		perror("Error (call to 'signalfd')");
+		return 0;
+	}
+	if (!GhEventAdd(sfd, GHEV_SIGNAL, EPOLLIN, fn, ctx)) {
+		close(sfd);
+		return 0;
+	}
+	return 1;
+}
+
+/** Reads pending inotify records and calls the matching watches
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhEventInotify(void) {
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event * ie;
+	ssize_t len;
+
+	while ((len = read(infd, buf, sizeof(buf))) > 0) {
+		for (char * p = buf; p < buf + len; p += sizeof(*ie) + ie->len) {
+			ie = (const struct inotify_event *) p;
+			for (int i = 0; i < GHMAXWATCHES; i++) {
+				if (watches[i].fn != NULL && watches[i].wd == ie->wd
+						&& ie->len > 0 && strcmp(watches[i].name, ie->name) == 0) {
+					watches[i].fn(infd, ie->mask, watches[i].ctx);
+				}
+			}
+		}
+	}
+}
+
+/** Dispatches one ready descriptor
+ * A handler may add descriptors and so move the table, h is not used
+ * after calling it.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param data slot and descriptor stored with the epoll registration
+ * @param events ready mask reported by epoll
+ */
+static void GhEventDispatch(uint64_t data, uint32_t events) {
+	struct signalfd_siginfo si;
+	uint64_t count;
+	uint32_t slot = (uint32_t) data;
+	int fd = (int)(data >> 32);
+	ghhandler_s * h = &handlers[slot];
+
+	// Removed, or removed and reused, earlier in the same batch
+	if (slot >= (uint32_t) nhandlers || h->fn == NULL || h->fd != fd) {
+		return;
+	}
+	switch (h->kind) {
+	case GHEV_TIMER:
+	case GHEV_NOTIFY:
+		// Drain the counter so a level triggered wakeup is not repeated
+		if (read(h->fd, &count, sizeof(count)) != sizeof(count)) {
+			return;
+		}
+		h->fn(h->fd, events, h->ctx);
+		break;
+	case GHEV_INOTIFY:
+		GhEventInotify();
+		break;
+	case GHEV_SIGNAL:
+		while (read(fd, &si, sizeof(si)) == sizeof(si)) {
+			h = &handlers[slot];
+			h->fn(fd, si.ssi_signo, h->ctx);
+		}
+		break;
+	default:
+		h->fn(h->fd, events, h->ctx);
+		break;
+	}
+}
+
+/** Runs the loop until GhEventStop is called
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 after a clean stop, 0 on error
+ */
+int GhEventRun(void) {
+	struct epoll_event evs[GHEVENTBATCH];
+	int n;
+
+	running = 1;
+	while (running) {
+		n = epoll_wait(epfd, evs, GHEVENTBATCH, -1);
+		if (n == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("Error (call to 'epoll_wait')");
+			return 0;
+		}
+		for (int i = 0; i < n && running; i++) {
+			GhEventDispatch(evs[i].data.u64, evs[i].events);
+		}
+	}
+	return 1;
+}
+
+/** Makes GhEventRun return after the current dispatch
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhEventStop(void) {
+	running = 0;
+}
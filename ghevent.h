@@ -0,0 +1,43 @@
+/** Event loop constants, structures, function prototypes
+ * @version ghevent.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHEVENT_H
+#define GHEVENT_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+// Constants ##############################################
+#define GHHANDLERSINIT 64   // handler slots, the table doubles when full
+#define GHMAXWATCHES 16
+#define GHWATCHNMSZ 64
+#define GHEVENTBATCH 16
+
+// Structures ##########################################
+typedef void (*ghhandler_f)(int fd, uint32_t events, void * ctx);
+
+typedef struct ghhandler {
+	int fd;
+	int kind;
+	ghhandler_f fn;
+	void * ctx;
+}ghhandler_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhEventInit(void);
+void GhEventExit(void);
+int GhEventAddFd(int fd, uint32_t events, ghhandler_f fn, void * ctx);
+int GhEventRemoveFd(int fd);
+int GhEventAddTimer(int milliseconds, ghhandler_f fn, void * ctx);
+int GhEventSetTimer(int tfd, int milliseconds, int periodic);
+int GhEventTimerLeft(int tfd);
+int GhEventAddNotify(ghhandler_f fn, void * ctx);
+int GhEventNotify(int efd);
+int GhEventWatchFile(const char * fname, ghhandler_f fn, void * ctx);
+int GhEventAddSignals(ghhandler_f fn, void * ctx);
+int GhEventRun(void);
+void GhEventStop(void);
+/// @endcond
+#endif
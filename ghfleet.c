@@ -0,0 +1,678 @@
+/** Fleet telemetry functions
+ * Frame encoding shared with the collector, and the ghc client that
+ * batches readings and alarm transitions into frames sent over UDP or TCP
+ * without ever blocking the control loop. With an outbox every record is
+ * first appended to disk with the sequence number of the frame it will go
+ * in, and frames are replayed from it until the collector acknowledges
+ * them. An uplink outage loses nothing, and a replay after a restart
+ * resends every frame under the number the collector already knows.
+ * @version ghfleet.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include "ghfleet.h"
+
+static int ffd = -1;                // collector socket
+static int ftcp;                    // non zero for a TCP stream
+static char fdest[128];             // host:port
+static struct sockaddr_storage faddr;// collector address, resolved once to reconnect TCP
+static socklen_t falen;
+static uint32_t fsource;
+static uint32_t fseq;
+static uint8_t fbuf[FLEETMAXFRAME]; // batch being built
+static int fcount;
+static time_t ffirst;               // time the oldest batched record was added
+static uint8_t fpend[FLEETMAXFRAME];// unsent tail of a TCP frame
+static size_t fplen, fpoff;
+static fleetstats_s fstats;
+static uint32_t ffirstseq;          // sequence number the session started with
+static int foutbox;                 // non zero when records go through the outbox
+static outboxpos_s fsend;           // first outbox record not yet framed
+static int fboxn;                   // outbox records stamped with fseq so far
+static uint8_t fboxbuf[FLEETBATCH * FLEETBOXRECSZ];
+static fleetflight_s fflight[FLEETWINDOW];
+static int fnflight;
+static long long fsentms;           // real ms of the last progress or resend
+static long long frto;              // current resend timeout
+static uint8_t frbuf[FLEETHDRSZ * 8];// acknowledgements being received
+static size_t frlen;
+
+/** Stores a little endian 16 bit value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhPut16(uint8_t * p, uint16_t v) {
+	p[0] = v & 0xFF;
+	p[1] = v >> 8;
+}
+
+/** Stores a little endian 32 bit value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhPut32(uint8_t * p, uint32_t v) {
+	GhPut16(p, v & 0xFFFF);
+	GhPut16(p + 2, v >> 16);
+}
+
+/** Loads a little endian 16 bit value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static uint16_t GhGet16(const uint8_t * p) {
+	return (uint16_t)(p[0] | p[1] << 8);
+}
+
+/** Loads a little endian 32 bit value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static uint32_t GhGet32(const uint8_t * p) {
+	return GhGet16(p) | (uint32_t) GhGet16(p + 2) << 16;
+}
+
+/** Converts a value to tenths clamped to 16 bits
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static int16_t GhTenths(double v) {
+	v = v * 10.0 + (v < 0 ? -0.5 : 0.5);
+	return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+/** Encodes a frame header
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param buf FLEETHDRSZ bytes
+ * @param hdr header to encode
+ */
+void GhFleetPutHeader(uint8_t * buf, fleethdr_s hdr) {
+	GhPut32(buf, hdr.magic);
+	buf[4] = hdr.version;
+	buf[5] = hdr.type;
+	buf[6] = hdr.flags;
+	buf[7] = hdr.count;
+	GhPut32(buf + 8, hdr.source);
+	GhPut32(buf + 12, hdr.seq);
+}
+
+/** Decodes and checks a frame header
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param buf received bytes
+ * @param len number of bytes available
+ * @param hdr receives the header
+ * @return frame length if the header is valid and complete, 0 otherwise
+ */
+int GhFleetGetHeader(const uint8_t * buf, size_t len, fleethdr_s * hdr) {
+	if (len < FLEETHDRSZ) {
+		return 0;
+	}
+	hdr->magic = GhGet32(buf);
+	hdr->version = buf[4];
+	hdr->type = buf[5];
+	hdr->flags = buf[6];
+	hdr->count = buf[7];
+	hdr->source = GhGet32(buf + 8);
+	hdr->seq = GhGet32(buf + 12);
+	if (hdr->magic != FLEETMAGIC || hdr->version != FLEETVERSION || hdr->count > FLEETBATCH) {
+		return 0;
+	}
+	return FLEETHDRSZ + hdr->count * FLEETRECSZ;
+}
+
+/** Encodes a record
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param buf FLEETRECSZ bytes
+ * @param rec record to encode
+ */
+void GhFleetPutRecord(uint8_t * buf, fleetrec_s rec) {
+	buf[0] = rec.kind;
+	buf[1] = rec.flags;
+	GhPut16(buf + 2, rec.code);
+	GhPut32(buf + 4, rec.time);
+	for (int i = 0; i < SENSORS; i++) {
+		GhPut16(buf + 8 + 2 * i, (uint16_t) rec.value[i]);
+	}
+	GhPut16(buf + 14, rec.reserved);
+}
+
+/** Decodes a record
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param buf FLEETRECSZ bytes
+ * @param rec receives the record
+ */
+void GhFleetGetRecord(const uint8_t * buf, fleetrec_s * rec) {
+	rec->kind = buf[0];
+	rec->flags = buf[1];
+	rec->code = GhGet16(buf + 2);
+	rec->time = GhGet32(buf + 4);
+	for (int i = 0; i < SENSORS; i++) {
+		rec->value[i] = (int16_t) GhGet16(buf + 8 + 2 * i);
+	}
+	rec->reserved = GhGet16(buf + 14);
+}
+
+/** Builds the record for a reading
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param rdata object of the structure readings named rdata
+ * @return record
+ */
+fleetrec_s GhFleetFromReading(reading_s rdata) {
+	fleetrec_s rec = {0};
+	rec.kind = FLEETREADING;
+	rec.time = (uint32_t) rdata.rtime;
+	rec.value[TEMPERATURE] = GhTenths(rdata.temperature);
+	rec.value[HUMIDITY] = GhTenths(rdata.humidity);
+	rec.value[PRESSURE] = GhTenths(rdata.pressure);
+	for (int i = 0; i < SENSORS; i++) {
+		rec.flags |= (rdata.quality[i] & 3) << (2 * i);
+	}
+	return rec;
+}
+
+/** Builds the record for an alarm transition
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param code alarm code
+ * @param atime time of the transition
+ * @param value reading that caused it
+ * @param raised 1 when the alarm was raised, 0 when it cleared
+ * @return record
+ */
+fleetrec_s GhFleetFromAlarm(alarm_e code, time_t atime, double value, int raised) {
+	fleetrec_s rec = {0};
+	rec.kind = FLEETALARM;
+	rec.flags = raised != 0;
+	rec.code = (uint16_t) code;
+	rec.time = (uint32_t) atime;
+	rec.value[0] = GhTenths(value);
+	return rec;
+}
+
+/** Looks up host:port, which may block on the resolver
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dest "host:port", the port defaults to FLEETPORT
+ * @param tcp non zero for a stream socket
+ * @param addr receives the first address found
+ * @param alen receives the length of addr
+ * @return 1 if successful, 0 on error
+ */
+int GhFleetResolve(const char * dest, int tcp, struct sockaddr_storage * addr, socklen_t * alen) {
+	struct addrinfo hints = {0}, * res;
+	char host[128], port[16];
+	const char * colon;
+
+	colon = strrchr(dest, ':');
+	snprintf(host, sizeof(host), "%.*s", colon ? (int)(colon - dest) : (int) strlen(dest), dest);
+	snprintf(port, sizeof(port), "%s", colon ? colon + 1 : "");
+	if (port[0] == '\0') {
+		snprintf(port, sizeof(port), "%d", FLEETPORT);
+	}
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = tcp ? SOCK_STREAM : SOCK_DGRAM;
+	if (getaddrinfo(host, port, &hints, &res) != 0) {
+		return 0;
+	}
+	memcpy(addr, res->ai_addr, res->ai_addrlen);
+	*alen = res->ai_addrlen;
+	freeaddrinfo(res);
+	return 1;
+}
+
+/** Opens a non-blocking socket to an address, never waiting
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param addr address from GhFleetResolve
+ * @param alen length of addr
+ * @param tcp non zero for a stream socket
+ * @return connected descriptor, -1 on error
+ */
+int GhFleetConnectAddr(const struct sockaddr_storage * addr, socklen_t alen, int tcp) {
+	int fd;
+
+	fd = socket(addr->ss_family, (tcp ? SOCK_STREAM : SOCK_DGRAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd != -1 && connect(fd, (const struct sockaddr *) addr, alen) == -1 && errno != EINPROGRESS) {
+		close(fd);
+		fd = -1;
+	}
+	return fd;
+}
+
+/** Opens a non-blocking socket to host:port
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dest "host:port", the port defaults to FLEETPORT
+ * @param tcp non zero for a stream socket
+ * @return connected descriptor, -1 on error
+ */
+int GhFleetConnect(const char * dest, int tcp) {
+	struct sockaddr_storage addr;
+	socklen_t alen;
+
+	if (!GhFleetResolve(dest, tcp, &addr, &alen)) {
+		return -1;
+	}
+	return GhFleetConnectAddr(&addr, alen, tcp);
+}
+
+/** Starts sending telemetry to a collector
+ * The address is resolved here, once, so a reconnect from the control
+ * loop never waits on the resolver.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dest collector "host:port"
+ * @param source identifier of this controller
+ * @param tcp non zero to use TCP instead of UDP
+ * @return 1 if successful, 0 on error
+ */
+int GhFleetOpen(const char * dest, uint32_t source, int tcp) {
+	snprintf(fdest, sizeof(fdest), "%s", dest);
+	fsource = source;
+	ftcp = tcp;
+	// A fresh random start keeps a restart from looking like duplicates
+	fseq = ffirstseq = (uint32_t) GhRealClock.millis() * 2654435761u ^ (uint32_t) getpid() << 16;
+	fcount = 0;
+	falen = 0;
+	if (!GhFleetResolve(fdest, ftcp, &faddr, &falen)) {
+		falen = 0;
+		return 0;
+	}
+	ffd = GhFleetConnectAddr(&faddr, falen, ftcp);
+	fstats.connects += ffd != -1;
+	return ffd != -1;
+}
+
+/** Sends records through a store and forward outbox from now on
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dir outbox directory
+ * @return 1 if successful, 0 if the outbox cannot be opened
+ */
+int GhFleetUseOutbox(const char * dir) {
+	if (!GhOutboxOpen(dir)) {
+		return 0;
+	}
+	foutbox = 1;
+	fsend = GhOutboxCursor();
+	fboxn = 0;
+	fnflight = 0;
+	frto = FLEETRTO;
+	ffirst = GhClockNow();
+	return 1;
+}
+
+/** Gets the collector socket, to wait for acknowledgements
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return descriptor, -1 when not connected
+ */
+int GhFleetFd(void) {
+	return ffd;
+}
+
+/** Closes the collector socket and forgets what was half sent or half
+ * received on it, a new stream must start on a frame boundary
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhFleetDrop(void) {
+	if (ffd != -1) {
+		close(ffd);
+	}
+	ffd = -1;
+	fplen = fpoff = 0;
+	frlen = 0;
+}
+
+/** Sends bytes without blocking, keeping an unsent TCP tail
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if everything was sent or queued, 0 if the frame was dropped
+ */
+static int GhFleetSend(const uint8_t * buf, size_t len) {
+	ssize_t n;
+
+	if (ffd == -1 && ftcp && falen > 0) {
+		ffd = GhFleetConnectAddr(&faddr, falen, ftcp);
+		fstats.connects += ffd != -1;
+		frlen = 0;
+	}
+	if (ffd == -1) {
+		return 0;
+	}
+	// A TCP stream must finish the previous frame before starting another
+	if (fplen > fpoff) {
+		n = send(ffd, fpend + fpoff, fplen - fpoff, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (n > 0) {
+			fpoff += n;
+		}
+		if (fplen > fpoff) {
+			if (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+				GhFleetDrop();
+			}
+			return 0;
+		}
+	}
+	n = send(ffd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (n == (ssize_t) len) {
+		return 1;
+	}
+	if (ftcp && n >= 0) {
+		memcpy(fpend, buf + n, len - n);
+		fplen = len - n;
+		fpoff = 0;
+		return 1;
+	}
+	if (ftcp && errno != EAGAIN && errno != EWOULDBLOCK) {
+		GhFleetDrop();
+	}
+	return 0;
+}
+
+/** Sends the current batch as one frame
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhFleetFlush(void) {
+	fleethdr_s hdr = { FLEETMAGIC, FLEETVERSION, FLEETDATA, 0, 0, 0, 0 };
+
+	if (fcount == 0 || fdest[0] == '\0') {
+		return;
+	}
+	if (foutbox) {
+		GhFleetPump(1);
+		return;
+	}
+	hdr.count = (uint8_t) fcount;
+	hdr.source = fsource;
+	hdr.flags = fseq == ffirstseq ? FLEETFIRST : 0;
+	hdr.seq = fseq++;
+	GhFleetPutHeader(fbuf, hdr);
+	if (GhFleetSend(fbuf, FLEETHDRSZ + fcount * FLEETRECSZ)) {
+		fstats.frames++;
+		fstats.records += fcount;
+	}
+	else {
+		fstats.dropped++;
+	}
+	fcount = 0;
+}
+
+/** Adds a record to the batch
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhFleetAdd(fleetrec_s rec) {
+	uint8_t buf[FLEETBOXRECSZ];
+
+	if (foutbox) {
+		if (!GhOutboxPending(fsend)) {
+			ffirst = GhClockNow();
+		}
+		GhPut32(buf, fseq);
+		GhFleetPutRecord(buf + 4, rec);
+		GhOutboxAppend(buf, FLEETBOXRECSZ);
+		if (++fboxn == FLEETBATCH) {
+			fseq++;
+			fboxn = 0;
+		}
+		return;
+	}
+	if (fcount == 0) {
+		ffirst = GhClockNow();
+	}
+	GhFleetPutRecord(fbuf + FLEETHDRSZ + fcount * FLEETRECSZ, rec);
+	fcount++;
+}
+
+/** Reads the frame stored at an outbox position into the batch buffer:
+ * the records from there on stamped with the first one's sequence number
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pos outbox position, moved past the frame
+ * @param seq receives the sequence number of the frame
+ * @return number of records, 0 if none are stored
+ */
+static int GhFleetReadFrame(outboxpos_s * pos, uint32_t * seq) {
+	outboxpos_s start = *pos;
+	int n, run;
+
+	n = GhOutboxRead(pos, fboxbuf, FLEETBOXRECSZ, FLEETBATCH);
+	if (n == 0) {
+		return 0;
+	}
+	*seq = GhGet32(fboxbuf);
+	for (run = 1; run < n && GhGet32(fboxbuf + run * FLEETBOXRECSZ) == *seq; run++) {
+	}
+	if (run < n) {
+		*pos = start;
+		GhOutboxRead(pos, fboxbuf, FLEETBOXRECSZ, run);
+	}
+	for (int i = 0; i < run; i++) {
+		memcpy(fbuf + FLEETHDRSZ + i * FLEETRECSZ, fboxbuf + i * FLEETBOXRECSZ + 4, FLEETRECSZ);
+	}
+	return run;
+}
+
+/** Sends the outbox records of a frame in flight
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fl frame to send
+ * @return 1 if the socket took it
+ */
+static int GhFleetSendFlight(fleetflight_s * fl) {
+	fleethdr_s hdr = { FLEETMAGIC, FLEETVERSION, FLEETDATA, FLEETWANTACK, 0, 0, 0 };
+	outboxpos_s pos = fl->start;
+	uint32_t seq;
+
+	hdr.count = (uint8_t) GhFleetReadFrame(&pos, &seq);
+	hdr.source = fsource;
+	hdr.seq = fl->seq;
+	hdr.flags |= fl->seq == ffirstseq ? FLEETFIRST : 0;
+	GhFleetPutHeader(fbuf, hdr);
+	return GhFleetSend(fbuf, FLEETHDRSZ + hdr.count * FLEETRECSZ);
+}
+
+/** Checks whether outbox position a comes before b
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static int GhFleetBefore(outboxpos_s a, outboxpos_s b) {
+	return a.seg < b.seg || (a.seg == b.seg && a.off < b.off);
+}
+
+/** Reads acknowledgements and moves the outbox cursor past every frame
+ * acknowledged in order
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhFleetReceive(void) {
+	fleethdr_s hdr;
+	size_t off;
+	ssize_t n = -1;
+	int done = 0;
+
+	while (ffd != -1 && (n = recv(ffd, frbuf + frlen, sizeof(frbuf) - frlen, MSG_DONTWAIT)) != 0) {
+		if (n == -1) {
+			if (ftcp && errno != EAGAIN && errno != EWOULDBLOCK) {
+				GhFleetDrop();
+			}
+			break;
+		}
+		frlen += n;
+		for (off = 0; frlen - off >= FLEETHDRSZ; off += FLEETHDRSZ) {
+			if (GhFleetGetHeader(frbuf + off, FLEETHDRSZ, &hdr) != FLEETHDRSZ
+					|| hdr.type != FLEETACK || hdr.source != fsource) {
+				continue;
+			}
+			for (int i = 0; i < fnflight; i++) {
+				if (fflight[i].seq == hdr.seq) {
+					fflight[i].acked = 1;
+				}
+			}
+		}
+		memmove(frbuf, frbuf + off, frlen - off);
+		frlen -= off;
+	}
+	if (n == 0 && ffd != -1) {
+		GhFleetDrop();
+	}
+	while (done < fnflight && fflight[done].acked) {
+		done++;
+	}
+	if (done == 0) {
+		return;
+	}
+	GhOutboxAck(fflight[done - 1].end);
+	fstats.acked += done;
+	for (int i = 0; i < done; i++) {
+		fstats.frames++;
+		fstats.records += fflight[i].count;
+	}
+	fnflight -= done;
+	memmove(fflight, fflight + done, fnflight * sizeof(fleetflight_s));
+	fsentms = GhRealClock.millis();
+	frto = FLEETRTO;
+}
+
+/** Moves the outbox: takes acknowledgements, resends what timed out and
+ * frames new records while the window allows. Never waits.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param force non zero to also send a partial batch
+ */
+void GhFleetPump(int force) {
+	fleetflight_s * fl;
+	outboxpos_s pos, cursor;
+	uint32_t seq;
+	long long ms;
+	int n;
+
+	if (!foutbox || fdest[0] == '\0') {
+		return;
+	}
+	GhFleetReceive();
+	ms = GhRealClock.millis();
+	cursor = GhOutboxCursor();
+	if (fnflight > 0 && GhFleetBefore(fflight[0].start, cursor)) {
+		// Evicted while unacknowledged, those frames are gone
+		fnflight = 0;
+	}
+	if (fnflight == 0) {
+		fsend = cursor;
+	}
+	if (fnflight > 0 && ms - fsentms >= frto) {
+		for (int i = 0; i < fnflight; i++) {
+			if (!fflight[i].acked) {
+				GhFleetSendFlight(&fflight[i]);
+				fstats.resent++;
+			}
+		}
+		fsentms = ms;
+		frto = frto * 2 > FLEETRTOMAX ? FLEETRTOMAX : frto * 2;
+	}
+	force |= GhClockNow() - ffirst >= FLEETFLUSH;
+	while (fnflight < FLEETWINDOW) {
+		pos = fsend;
+		n = GhFleetReadFrame(&pos, &seq);
+		// The frame still being filled waits until it is full or old
+		if (n == 0 || (seq == fseq && !force)) {
+			break;
+		}
+		if (seq == fseq) {
+			fseq++;
+			fboxn = 0;
+		}
+		fl = &fflight[fnflight++];
+		fl->seq = seq;
+		fl->start = fsend;
+		fl->end = pos;
+		fl->count = n;
+		fl->acked = 0;
+		if (fnflight == 1) {
+			fsentms = ms;
+		}
+		if (!GhFleetSendFlight(fl)) {
+			fstats.dropped++;
+		}
+		fsend = pos;
+		ffirst = GhClockNow();
+	}
+	GhOutboxSync();
+}
+
+/** Queues a reading, sending the batch when it is full or old
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param rdata object of the structure readings named rdata
+ */
+void GhFleetReading(reading_s rdata) {
+	if (fdest[0] == '\0') {
+		return;
+	}
+	GhFleetAdd(GhFleetFromReading(rdata));
+	if (foutbox) {
+		GhFleetPump(0);
+	}
+	else if (fcount == FLEETBATCH || GhClockNow() - ffirst >= FLEETFLUSH) {
+		GhFleetFlush();
+	}
+}
+
+/** Queues an alarm transition and sends the batch at once
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param code alarm code
+ * @param atime time of the transition
+ * @param value reading that caused it
+ * @param raised 1 when the alarm was raised, 0 when it cleared
+ */
+void GhFleetAlarm(alarm_e code, time_t atime, double value, int raised) {
+	if (fdest[0] == '\0') {
+		return;
+	}
+	GhFleetAdd(GhFleetFromAlarm(code, atime, value, raised));
+	GhFleetFlush();
+}
+
+/** Sends what is batched and closes the socket
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhFleetClose(void) {
+	long long until = GhRealClock.millis() + FLEETDRAINMS;
+	struct pollfd pfd;
+
+	GhFleetFlush();
+	// Give a reachable collector a moment to take the rest of the outbox
+	while (foutbox && ffd != -1 && (fnflight > 0 || GhOutboxPending(fsend))
+			&& GhRealClock.millis() < until) {
+		pfd.fd = ffd;
+		pfd.events = POLLIN;
+		poll(&pfd, 1, 50);
+		GhFleetPump(1);
+	}
+	if (foutbox) {
+		GhOutboxClose();
+		foutbox = 0;
+	}
+	GhFleetDrop();
+	fdest[0] = '\0';
+}
+
+/** Gets client counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return frames and records sent, frames dropped
+ */
+fleetstats_s GhFleetStats(void) {
+	return fstats;
+}
@@ -0,0 +1,98 @@
+/** Fleet telemetry constants, structures, function prototypes
+ * Frames are a 16 byte header followed by count 16 byte records, every
+ * field little endian.
+ * @version ghfleet.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHFLEET_H
+#define GHFLEET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/socket.h>
+#include "ghcontrol.h"
+#include "ghoutbox.h"
+
+// Constants ##############################################
+#define FLEETMAGIC 0x31464847u  // "GHF1"
+#define FLEETVERSION 1
+#define FLEETPORT 5153
+#define FLEETHDRSZ 16
+#define FLEETRECSZ 16
+#define FLEETBOXRECSZ (4 + FLEETRECSZ) // outbox record: sequence number of its frame, then the record
+#define FLEETBATCH 64           // records per frame
+#define FLEETMAXFRAME (FLEETHDRSZ + FLEETBATCH * FLEETRECSZ)
+#define FLEETFLUSH 10           // seconds a partial batch may wait
+#define FLEETDATA 1             // frame types
+#define FLEETACK 2
+#define FLEETWANTACK 0x01       // header flag asking the collector to acknowledge
+#define FLEETFIRST 0x02         // header flag on the first frame of a session
+#define FLEETWINDOW 32          // unacknowledged outbox frames in flight
+#define FLEETRTO 1000           // ms before unacknowledged frames are resent
+#define FLEETRTOMAX 30000       // resend backoff limit while the uplink is down
+#define FLEETDRAINMS 2000       // ms GhFleetClose may spend draining the outbox
+#define FLEETREADING 1          // record kinds
+#define FLEETALARM 2
+
+// Structures ##########################################
+typedef struct fleethdr {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t type;
+	uint8_t flags;
+	uint8_t count;
+	uint32_t source;
+	uint32_t seq;
+}fleethdr_s;
+
+typedef struct fleetrec {
+	uint8_t kind;
+	uint8_t flags;          // 2 bit quality per sensor, or 1 for a raised alarm
+	uint16_t code;          // alarm code
+	uint32_t time;
+	int16_t value[SENSORS]; // tenths: T, H, P for readings, value for alarms
+	uint16_t reserved;
+}fleetrec_s;
+
+typedef struct fleetstats {
+	long frames;
+	long records;
+	long dropped;           // frames a non-blocking send could not take
+	long acked;             // outbox frames the collector acknowledged
+	long resent;            // outbox frames sent again after a timeout
+	long connects;          // sockets opened, to notice a new descriptor
+}fleetstats_s;
+
+typedef struct fleetflight {
+	uint32_t seq;
+	outboxpos_s start;      // outbox range the frame carries
+	outboxpos_s end;
+	int count;
+	int acked;
+}fleetflight_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+// Encoding
+void GhFleetPutHeader(uint8_t * buf, fleethdr_s hdr);
+int GhFleetGetHeader(const uint8_t * buf, size_t len, fleethdr_s * hdr);
+void GhFleetPutRecord(uint8_t * buf, fleetrec_s rec);
+void GhFleetGetRecord(const uint8_t * buf, fleetrec_s * rec);
+fleetrec_s GhFleetFromReading(reading_s rdata);
+fleetrec_s GhFleetFromAlarm(alarm_e code, time_t atime, double value, int raised);
+// Client
+int GhFleetOpen(const char * dest, uint32_t source, int tcp);
+void GhFleetReading(reading_s rdata);
+void GhFleetAlarm(alarm_e code, time_t atime, double value, int raised);
+void GhFleetFlush(void);
+void GhFleetClose(void);
+fleetstats_s GhFleetStats(void);
+int GhFleetResolve(const char * dest, int tcp, struct sockaddr_storage * addr, socklen_t * alen);
+int GhFleetConnectAddr(const struct sockaddr_storage * addr, socklen_t alen, int tcp);
+int GhFleetConnect(const char * dest, int tcp);
+int GhFleetUseOutbox(const char * dir);
+void GhFleetPump(int force);
+int GhFleetFd(void);
+/// @endcond
+#endif
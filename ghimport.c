@@ -0,0 +1,472 @@
+/** Bulk importer for GhLogData archives
+ * Maps each ghdata.txt, splits it into chunks on line boundaries and
+ * parses the chunks in parallel on the thread pool into a columnar file
+ * that ghsweep loads directly. Rows are parsed by position rather than
+ * with sscanf: the time stamp is the fixed width patched ctime() field,
+ * the month is matched as three bytes and values are read straight into
+ * tenths, so no locale, strtod or strlen is involved.
+ * @version ghimport.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ghcontrol.h"
+#include "ghcolumn.h"
+#include "ghpool.h"
+
+// Constants ##############################################
+#define IMPORTOUT "ghdata.col"
+#define IMPORTCHUNK (4 << 20)   // bytes a task parses
+#define IMPORTMINROW 31         // shortest row that can parse, with its newline
+#define IMPORTLINESZ 256        // line buffer of the sscanf benchmark, as ghsweep reads
+#define IMPORTDIGIT(c) ((unsigned)((c) - '0') < 10)
+#define IMPORTALPHA(c) ((unsigned)(((c) | 0x20) - 'a') < 26)
+#define IMPORTMON(a,b,c) ((a) << 16 | (b) << 8 | (c))
+
+// Structures ##########################################
+typedef struct chunk {
+	const unsigned char * start;
+	const unsigned char * end;
+	columns_s cols;
+	long bad;
+	const unsigned char * firstbad;   // start of the first malformed row
+}chunk_s;
+
+typedef struct importfile {
+	const char * name;
+	unsigned char * map;
+	size_t size;
+	long first;                 // index of its first chunk
+	long nchunks;
+}importfile_s;
+
+/** Reads the monotonic clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return microseconds
+ */
+static long long GhImportMicros(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+/** Parses a value of a row into tenths, rounding any further digits
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param p first character, leading spaces are skipped
+ * @param e end of the row
+ * @param v receives the value
+ * @return character after the value, NULL if there is no value or it is
+ * out of the column's range
+ */
+static const unsigned char * GhImportTenths(const unsigned char * p, const unsigned char * e, int16_t * v) {
+	int x = 0, neg = 0, digits = 0;
+
+	while (p < e && *p == ' ') {
+		p++;
+	}
+	if (p < e && *p == '-') {
+		neg = 1;
+		p++;
+	}
+	for (; p < e && IMPORTDIGIT(*p) && x <= COLMAX; p++, digits++) {
+		x = x * 10 + (*p - '0');
+	}
+	x *= 10;
+	if (p < e && *p == '.') {
+		p++;
+		if (p < e && IMPORTDIGIT(*p)) {
+			x += *p++ - '0';
+			digits++;
+		}
+		if (p < e && IMPORTDIGIT(*p)) {
+			x += *p >= '5';
+		}
+		while (p < e && IMPORTDIGIT(*p)) {
+			p++;
+		}
+	}
+	x = neg ? -x : x;
+	if (digits == 0 || x < COLMIN || x > COLMAX) {
+		return NULL;
+	}
+	*v = (int16_t) x;
+	return p;
+}
+
+/** Parses one GhLogData row, Day,Mon,DD,HH:MM:SS,YYYY,T,H,P
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param p first character of the row
+ * @param e its newline or the end of the chunk
+ * @param t receives the time stamp
+ * @param v receives the values in tenths
+ * @return 1 if successful, 0 if the row is malformed
+ */
+static int GhImportRow(const unsigned char * p, const unsigned char * e, int64_t * t, int16_t v[SENSORS]) {
+	int m, day, hh, mm, ss, year;
+	long long days;
+
+	if (e > p && e[-1] == '\r') {
+		e--;
+	}
+	if (e - p < IMPORTMINROW - 1 || p[3] != ',' || p[7] != ',' || p[10] != ',' || p[13] != ':'
+			|| p[16] != ':' || p[19] != ',' || p[24] != ','
+			|| !IMPORTALPHA(p[0]) || !IMPORTALPHA(p[1]) || !IMPORTALPHA(p[2])) {
+		return 0;
+	}
+	switch (IMPORTMON(p[4], p[5], p[6])) {
+		case IMPORTMON('J','a','n'): m = 1; break;
+		case IMPORTMON('F','e','b'): m = 2; break;
+		case IMPORTMON('M','a','r'): m = 3; break;
+		case IMPORTMON('A','p','r'): m = 4; break;
+		case IMPORTMON('M','a','y'): m = 5; break;
+		case IMPORTMON('J','u','n'): m = 6; break;
+		case IMPORTMON('J','u','l'): m = 7; break;
+		case IMPORTMON('A','u','g'): m = 8; break;
+		case IMPORTMON('S','e','p'): m = 9; break;
+		case IMPORTMON('O','c','t'): m = 10; break;
+		case IMPORTMON('N','o','v'): m = 11; break;
+		case IMPORTMON('D','e','c'): m = 12; break;
+		default: return 0;
+	}
+	// ctime() pads the day with a space
+	if ((p[8] != ' ' && !IMPORTDIGIT(p[8])) || !IMPORTDIGIT(p[9])
+			|| !IMPORTDIGIT(p[11]) || !IMPORTDIGIT(p[12]) || !IMPORTDIGIT(p[14]) || !IMPORTDIGIT(p[15])
+			|| !IMPORTDIGIT(p[17]) || !IMPORTDIGIT(p[18]) || !IMPORTDIGIT(p[20]) || !IMPORTDIGIT(p[21])
+			|| !IMPORTDIGIT(p[22]) || !IMPORTDIGIT(p[23])) {
+		return 0;
+	}
+	day = (p[8] == ' ' ? 0 : (p[8] - '0') * 10) + p[9] - '0';
+	hh = (p[11] - '0') * 10 + p[12] - '0';
+	mm = (p[14] - '0') * 10 + p[15] - '0';
+	ss = (p[17] - '0') * 10 + p[18] - '0';
+	year = (p[20] - '0') * 1000 + (p[21] - '0') * 100 + (p[22] - '0') * 10 + p[23] - '0';
+	if (day < 1 || day > 31 || hh > 23 || mm > 59 || ss > 60) {
+		return 0;
+	}
+	p += 25;
+	for (int s = 0; s < SENSORS; s++) {
+		p = GhImportTenths(p, e, &v[s]);
+		if (p == NULL || (s < SENSORS - 1 && (p >= e || *p++ != ','))) {
+			return 0;
+		}
+	}
+	if (p != e) {
+		return 0;
+	}
+	// Days from civil (proleptic Gregorian), March based year, as GhParseLogRow
+	year -= m <= 2;
+	days = 365LL * year + year / 4 - year / 100 + year / 400
+		+ (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + day - 1 - 719468;
+	*t = days * 86400 + hh * 3600 + mm * 60 + ss;
+	return 1;
+}
+
+/** Parses every row of a chunk into its columns
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param arg chunk_s to parse, its columns hold room for every row
+ */
+static void GhImportChunk(void * arg) {
+	chunk_s * c = arg;
+	const unsigned char * p = c->start, * eol;
+	int16_t v[SENSORS];
+	long n = 0;
+
+	c->bad = 0;
+	c->firstbad = NULL;
+	while (p < c->end) {
+		eol = memchr(p, '\n', c->end - p);
+		eol = eol == NULL ? c->end : eol;
+		if (GhImportRow(p, eol, &c->cols.t[n], v)) {
+			c->cols.v[TEMPERATURE][n] = v[TEMPERATURE];
+			c->cols.v[HUMIDITY][n] = v[HUMIDITY];
+			c->cols.v[PRESSURE][n] = v[PRESSURE];
+			n++;
+		}
+		else {
+			c->firstbad = c->bad++ == 0 ? p : c->firstbad;
+		}
+		p = eol + 1;
+	}
+	c->cols.rows = n;
+}
+
+/** Maps a file and splits it into chunks that end on a newline
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param f file to map, its name set
+ * @param chunks chunk array, grown as needed
+ * @param nchunks number of chunks so far
+ * @param populate 1 to read the whole file in before returning
+ * @return 1 if successful, 0 on error
+ */
+static int GhImportMap(importfile_s * f, chunk_s ** chunks, long * nchunks, int populate) {
+	static long cap = 0;
+	struct stat st;
+	chunk_s * grown, * c;
+	const unsigned char * p, * end, * nl;
+	long rows;
+	int fd;
+
+	fd = open(f->name, O_RDONLY | O_CLOEXEC);
+	if (fd == -1 || fstat(fd, &st) == -1) {
+		fprintf(stderr, "Can't open %s\n", f->name);
+		if (fd != -1) {
+			close(fd);
+		}
+		return 0;
+	}
+	f->size = (size_t) st.st_size;
+	f->first = *nchunks;
+	f->nchunks = 0;
+	f->map = NULL;
+	if (f->size > 0) {
+		f->map = mmap(NULL, f->size, PROT_READ, MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+	}
+	close(fd);
+	if (f->map == MAP_FAILED) {
+		perror("Error (call to 'mmap')");
+		f->map = NULL;
+		return 0;
+	}
+	if (f->map == NULL) {
+		return 1;
+	}
+	// The advice values are not flags, each takes a call of its own
+	madvise(f->map, f->size, MADV_SEQUENTIAL);
+	madvise(f->map, f->size, MADV_WILLNEED);
+
+	for (p = f->map, end = f->map + f->size; p < end; p = c->end) {
+		if (*nchunks == cap) {
+			cap = cap ? cap * 2 : 64;
+			grown = realloc(*chunks, cap * sizeof(chunk_s));
+			if (grown == NULL) {
+				return 0;
+			}
+			*chunks = grown;
+		}
+		c = &(*chunks)[(*nchunks)++];
+		memset(c, 0, sizeof(chunk_s));
+		c->start = p;
+		c->end = end - p > IMPORTCHUNK ? p + IMPORTCHUNK : end;
+		if (c->end < end) {
+			nl = memchr(c->end, '\n', end - c->end);
+			c->end = nl == NULL ? end : nl + 1;
+		}
+		// Every row takes at least IMPORTMINROW bytes but a last row may
+		// lack its newline
+		rows = (c->end - c->start) / IMPORTMINROW + 1;
+		c->cols.t = malloc(rows * sizeof(int64_t));
+		for (int s = 0; s < SENSORS; s++) {
+			c->cols.v[s] = malloc(rows * sizeof(int16_t));
+		}
+		if (c->cols.t == NULL || c->cols.v[TEMPERATURE] == NULL
+				|| c->cols.v[HUMIDITY] == NULL || c->cols.v[PRESSURE] == NULL) {
+			return 0;
+		}
+		f->nchunks++;
+	}
+	return 1;
+}
+
+/** Reports the malformed rows of a file with the line of the first
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param f file
+ * @param chunks its chunks are f->first onwards
+ * @return malformed rows in the file
+ */
+static long GhImportBad(const importfile_s * f, const chunk_s * chunks) {
+	const unsigned char * first = NULL, * p, * nl, * e;
+	long bad = 0, line = 1;
+	int len;
+
+	for (long i = f->first; i < f->first + f->nchunks; i++) {
+		bad += chunks[i].bad;
+		first = first == NULL ? chunks[i].firstbad : first;
+	}
+	if (bad == 0) {
+		return 0;
+	}
+	for (p = f->map; (nl = memchr(p, '\n', first - p)) != NULL; p = nl + 1) {
+		line++;
+	}
+	e = memchr(first, '\n', f->map + f->size - first);
+	len = (int)((e == NULL ? f->map + f->size : e) - first);
+	fprintf(stderr, "%s: %ld malformed rows, first at line %ld: %.*s\n",
+		f->name, bad, line, len > 60 ? 60 : len, (const char *) first);
+	return bad;
+}
+
+/** Times GhParseLogRow over the files on one thread, as ghsweep read them
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return microseconds taken
+ */
+static long long GhImportSscanf(const importfile_s * files, int nfiles, long * rows) {
+	char line[IMPORTLINESZ];
+	const unsigned char * p, * e, * nl;
+	reading_s r;
+	long long start = GhImportMicros();
+	size_t len;
+
+	*rows = 0;
+	for (int i = 0; i < nfiles; i++) {
+		e = files[i].map + files[i].size;
+		for (p = files[i].map; p != NULL && p < e; p = nl == NULL ? NULL : nl + 1) {
+			nl = memchr(p, '\n', e - p);
+			len = (size_t)((nl == NULL ? e : nl) - p);
+			len = len < sizeof(line) - 1 ? len : sizeof(line) - 1;
+			memcpy(line, p, len);
+			line[len] = '\0';
+			*rows += GhParseLogRow(line, &r);
+		}
+	}
+	return GhImportMicros() - start;
+}
+
+/** Prints one benchmark line
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhImportBenchLine(const char * name, int threads, long long us, double mb, long rows) {
+	fprintf(stderr, "%-8s %3d thread%s %9.1lf ms %9.1lf MB/s %9.1lf MB/s per thread %9ld rows\n",
+		name, threads, threads == 1 ? " " : "s", us / 1000.0,
+		mb / (us > 0 ? us : 1) * 1e6, mb / (us > 0 ? us : 1) * 1e6 / threads, rows);
+}
+
+/** Prints the usage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhImportUsage(const char * pname) {
+	fprintf(stderr, "Usage: %s [-j threads] [-o out] [-b] ghdata.txt...\n"
+		"  -o columnar file to write, default %s\n"
+		"  -b also time a single thread of this parser and of sscanf\n", pname, IMPORTOUT);
+}
+
+int main(int argc, char * argv[]) {
+	const char * out = IMPORTOUT;
+	importfile_s * files;
+	chunk_s * chunks = NULL;
+	columns_s cols = {0};
+	ghpool_s * pool;
+	long nchunks = 0, bad = 0, n, srows;
+	long long us, us1, ussc;
+	double mb = 0.0;
+	int opt, threads = 0, bench = 0, nfiles, nthreads, ok = 1;
+
+	while ((opt = getopt(argc, argv, "j:o:bh")) != -1) {
+		if (opt == 'j') {
+			threads = atoi(optarg);
+		}
+		else if (opt == 'o') {
+			out = optarg;
+		}
+		else if (opt == 'b') {
+			bench = 1;
+		}
+		else {
+			GhImportUsage(argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc) {
+		GhImportUsage(argv[0]);
+		return 1;
+	}
+	nfiles = argc - optind;
+	files = calloc(nfiles, sizeof(importfile_s));
+	pool = GhPoolCreate(threads);
+	if (files == NULL || pool == NULL) {
+		fprintf(stderr, "Cannot allocate memory\n");
+		return 1;
+	}
+	// The benchmark reads the files in first so every parser sees them in memory
+	for (int i = 0; i < nfiles; i++) {
+		files[i].name = argv[optind + i];
+		if (!GhImportMap(&files[i], &chunks, &nchunks, bench)) {
+			fprintf(stderr, "Can't import %s\n", files[i].name);
+			return 1;
+		}
+		mb += files[i].size / 1e6;
+	}
+
+	us = GhImportMicros();
+	for (long i = 0; i < nchunks; i++) {
+		GhPoolSubmit(pool, GhImportChunk, &chunks[i]);
+	}
+	GhPoolWait(pool);
+	us = GhImportMicros() - us;
+	nthreads = pool->nthreads;
+	GhPoolDestroy(pool);
+
+	// Concatenate the chunks in file order
+	for (long i = 0; i < nchunks; i++) {
+		cols.rows += chunks[i].cols.rows;
+	}
+	cols.t = malloc((cols.rows + 1) * sizeof(int64_t));
+	for (int s = 0; s < SENSORS; s++) {
+		cols.v[s] = malloc((cols.rows + 1) * sizeof(int16_t));
+	}
+	if (cols.t == NULL || cols.v[TEMPERATURE] == NULL || cols.v[HUMIDITY] == NULL || cols.v[PRESSURE] == NULL) {
+		fprintf(stderr, "Cannot allocate memory\n");
+		return 1;
+	}
+	n = 0;
+	for (long i = 0; i < nchunks; i++) {
+		memcpy(&cols.t[n], chunks[i].cols.t, chunks[i].cols.rows * sizeof(int64_t));
+		for (int s = 0; s < SENSORS; s++) {
+			memcpy(&cols.v[s][n], chunks[i].cols.v[s], chunks[i].cols.rows * sizeof(int16_t));
+		}
+		n += chunks[i].cols.rows;
+	}
+	for (int i = 0; i < nfiles; i++) {
+		bad += GhImportBad(&files[i], chunks);
+	}
+	if (!GhColumnWrite(out, &cols)) {
+		fprintf(stderr, "Can't write %s\n", out);
+		ok = 0;
+	}
+	fprintf(stderr, "%ld rows (%ld malformed) from %.1lf MB in %lld ms on %d threads (%.1lf MB/s), %s %s\n",
+		cols.rows, bad, mb, us / 1000, nthreads, mb / (us > 0 ? us : 1) * 1e6,
+		ok ? "wrote" : "did not write", out);
+
+	if (bench) {
+		us1 = GhImportMicros();
+		for (long i = 0; i < nchunks; i++) {
+			GhImportChunk(&chunks[i]);
+		}
+		us1 = GhImportMicros() - us1;
+		ussc = GhImportSscanf(files, nfiles, &srows);
+		GhImportBenchLine("sscanf", 1, ussc, mb, srows);
+		GhImportBenchLine("ghimport", 1, us1, mb, cols.rows);
+		GhImportBenchLine("ghimport", nthreads, us, mb, cols.rows);
+	}
+
+	for (long i = 0; i < nchunks; i++) {
+		free(chunks[i].cols.t);
+		for (int s = 0; s < SENSORS; s++) {
+			free(chunks[i].cols.v[s]);
+		}
+	}
+	for (int i = 0; i < nfiles; i++) {
+		if (files[i].map != NULL) {
+			munmap(files[i].map, files[i].size);
+		}
+	}
+	free(chunks);
+	free(files);
+	free(cols.t);
+	for (int s = 0; s < SENSORS; s++) {
+		free(cols.v[s]);
+	}
+	return ok ? 0 : 1;
+}
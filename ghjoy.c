@@ -0,0 +1,238 @@
+/** Sense HAT joystick functions
+ * The joystick is an evdev device found by name under /dev/input. Its
+ * non-blocking descriptor sits in the event loop, so an idle joystick
+ * costs no wakeups. A regular file of recorded input_event structures
+ * (cat /dev/input/eventN > file) is replayed on a one-shot timer at the
+ * pace it was recorded.
+ * @version ghjoy.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <errno.h>
+#include "ghjoy.h"
+
+static int joyfd = -1;
+static int joytfd = -1;
+static joykey_f joyfn;
+static struct input_event replay[JOYREPLAYMAX];
+static long nreplay, replaypos;
+static long long replaystart;
+static int selected;            // 0 temperature, 1 humidity
+static time_t lastpress;
+static joystats_s jstats;
+
+/** Hands a key press or repeat on
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhJoyHandle(const struct input_event * ev) {
+	jstats.events++;
+	// value 1 is a press, 2 an autorepeat, 0 a release
+	if (ev->type == EV_KEY && ev->value != 0) {
+		jstats.presses++;
+		joyfn(ev->code);
+	}
+}
+
+/** Takes every event waiting on the device
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhJoyEvent(int fd, uint32_t events, void * ctx) {
+	struct input_event evs[JOYBATCH];
+	ssize_t len;
+
+	while ((len = read(fd, evs, sizeof(evs))) > 0) {
+		for (int i = 0; i < len / (ssize_t) sizeof(struct input_event); i++) {
+			GhJoyHandle(&evs[i]);
+		}
+	}
+	if (len == 0 || (errno != EAGAIN && errno != EINTR)) {
+		// Unplugged
+		GhEventRemoveFd(fd);
+		close(fd);
+		joyfd = -1;
+	}
+}
+
+/** Milliseconds from the first recorded event to event i
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static long long GhJoyOffset(long i) {
+	// Not .time, which 32 bit userlands with a 64 bit time_t do not have
+	return (replay[i].input_event_sec - replay[0].input_event_sec) * 1000LL
+		+ ((long long) replay[i].input_event_usec - replay[0].input_event_usec) / 1000;
+}
+
+/** Replays the recorded events now due and arms the timer for the next
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhJoyReplay(int fd, uint32_t events, void * ctx) {
+	long long now = GhRealClock.millis() - replaystart;
+	long long wait;
+
+	while (replaypos < nreplay && GhJoyOffset(replaypos) <= now) {
+		GhJoyHandle(&replay[replaypos++]);
+	}
+	if (replaypos < nreplay) {
+		wait = GhJoyOffset(replaypos) - now;
+		GhEventSetTimer(joytfd, wait < 1 ? 1 : (int) wait, 0);
+	}
+}
+
+/** Finds the joystick among the evdev devices by name
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return non-blocking descriptor, -1 if there is none
+ */
+static int GhJoyFind(void) {
+	char path[JOYPATHSZ], name[64];
+	struct dirent * de;
+	DIR * dir;
+	int fd = -1;
+
+	dir = opendir(JOYDIR);
+	if (dir == NULL) {
+		return -1;
+	}
+	while (fd == -1 && (de = readdir(dir)) != NULL) {
+		if (strncmp(de->d_name, "event", 5) != 0) {
+			continue;
+		}
+		snprintf(path, sizeof(path), "%s/%s", JOYDIR, de->d_name);
+		fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd == -1) {
+			continue;
+		}
+		memset(name, 0, sizeof(name));
+		if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) == -1 || strcmp(name, JOYNAME) != 0) {
+			close(fd);
+			fd = -1;
+		}
+	}
+	closedir(dir);
+	return fd;
+}
+
+/** Opens the joystick and adds it to the event loop
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dev "auto" or NULL to find the Sense HAT joystick, an evdev device,
+ * or a file of recorded events to replay
+ * @param fn called in the loop thread with the code of every key press and repeat
+ * @return 1 if successful, 0 on error
+ */
+int GhJoyOpen(const char * dev, joykey_f fn) {
+	struct stat st;
+	FILE * fp;
+
+	joyfn = fn;
+	if (dev != NULL && strcmp(dev, "auto") != 0 && stat(dev, &st) == 0 && S_ISREG(st.st_mode)) {
+		fp = fopen(dev, "rb");
+		if (fp == NULL) {
+			return 0;
+		}
+		nreplay = (long) fread(replay, sizeof(struct input_event), JOYREPLAYMAX, fp);
+		fclose(fp);
+		replaypos = 0;
+		replaystart = GhRealClock.millis();
+		joytfd = GhEventAddTimer(0, GhJoyReplay, NULL);
+		if (joytfd == -1) {
+			return 0;
+		}
+		GhJoyReplay(joytfd, 0, NULL);
+		return 1;
+	}
+	if (dev == NULL || strcmp(dev, "auto") == 0) {
+		joyfd = GhJoyFind();
+	}
+	else {
+		joyfd = open(dev, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	}
+	if (joyfd == -1) {
+		return 0;
+	}
+	if (!GhEventAddFd(joyfd, EPOLLIN, GhJoyEvent, NULL)) {
+		close(joyfd);
+		joyfd = -1;
+		return 0;
+	}
+	return 1;
+}
+
+/** Closes the joystick or stops the replay
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhJoyClose(void) {
+	if (joyfd != -1) {
+		GhEventRemoveFd(joyfd);
+		close(joyfd);
+		joyfd = -1;
+	}
+	if (joytfd != -1) {
+		GhEventRemoveFd(joytfd);
+		close(joytfd);
+		joytfd = -1;
+	}
+}
+
+/** Applies a key to the setpoints: left selects temperature and right
+ * humidity, up and down nudge the selected setpoint
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param spts current setpoints
+ * @param key evdev key code
+ * @param now time of the press
+ * @return new setpoints
+ */
+setpoint_s GhJoyNudge(setpoint_s spts, int key, time_t now) {
+	double step = key == KEY_UP ? 1.0 : (key == KEY_DOWN ? -1.0 : 0.0);
+
+	lastpress = now;
+	if (key == KEY_LEFT) {
+		selected = 0;
+	}
+	else if (key == KEY_RIGHT) {
+		selected = 1;
+	}
+	else if (step != 0.0 && selected == 0) {
+		spts.temperature += step * JOYTSTEP;
+		spts.temperature = spts.temperature < LSTEMP ? LSTEMP : (spts.temperature > USTEMP ? USTEMP : spts.temperature);
+		jstats.nudges++;
+	}
+	else if (step != 0.0) {
+		spts.humidity += step * JOYHSTEP;
+		spts.humidity = spts.humidity < LSHUMID ? LSHUMID : (spts.humidity > USHUMID ? USHUMID : spts.humidity);
+		jstats.nudges++;
+	}
+	return spts;
+}
+
+/** Lights a column beside the selected setpoint's bar for JOYHOLD seconds
+ * after the last press
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now current time
+ */
+void GhJoyDisplay(time_t now) {
+	fbpixel_s pxc = {0};
+
+	if (lastpress == 0 || now - lastpress > JOYHOLD) {
+		return;
+	}
+	pxc.blue = 0x0F;
+	for (int y = 0; y < 8; y++) {
+		ShSetPixel((selected == 0 ? TBAR : HBAR) - 1, y, pxc);
+	}
+}
+
+/** Gets the joystick counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return counters
+ */
+joystats_s GhJoyStats(void) {
+	return jstats;
+}
@@ -0,0 +1,38 @@
+/** Sense HAT joystick constants, structures, function prototypes
+ * @version ghjoy.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHJOY_H
+#define GHJOY_H
+
+#include "ghcontrol.h"
+#include "ghevent.h"
+
+// Constants ##############################################
+#define JOYNAME "Raspberry Pi Sense HAT Joystick"
+#define JOYDIR "/dev/input"
+#define JOYPATHSZ 280
+#define JOYTSTEP 0.5            // degrees C per nudge
+#define JOYHSTEP 1.0            // % RH per nudge
+#define JOYHOLD 5               // seconds the selection marker stays lit after a press
+#define JOYREPLAYMAX 4096       // events kept from a recording
+#define JOYBATCH 16             // events taken per read
+
+// Structures ##########################################
+typedef void (*joykey_f)(int key);
+
+typedef struct joystats {
+	long events;            // input events read
+	long presses;           // key presses and repeats handed on
+	long nudges;            // setpoint changes
+}joystats_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhJoyOpen(const char * dev, joykey_f fn);
+void GhJoyClose(void);
+setpoint_s GhJoyNudge(setpoint_s spts, int key, time_t now);
+void GhJoyDisplay(time_t now);
+joystats_s GhJoyStats(void);
+/// @endcond
+#endif
@@ -0,0 +1,456 @@
+/** Alarm notification functions
+ * The control loop only posts transitions onto a bounded queue, a short
+ * critical section that never waits on a sink. One worker thread folds
+ * them into one pending notice per alarm code, so a flapping alarm is
+ * delivered as its latest state with a transition count, holds each code
+ * to one delivery per NOTIFYRATE seconds, and delivers to every sink with
+ * retries and backoff.
+ * @version ghnotify.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "ghnotify.h"
+#include "ghrt.h"
+
+static notifysink_s sinks[NOTIFYSINKS];
+static int nsinks;
+static notice_s queue[NOTIFYQUEUE];
+static int qhead, qlen;
+static pthread_mutex_t nlock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ncond = PTHREAD_COND_INITIALIZER;
+static pthread_t nthread;
+static int nrunning;
+static int nstop;
+static long long ndeadline;         // real ms after which a stopping worker gives up
+static notifystats_s nstats;
+// Worker only
+static notice_s held[NALARMS];
+static int isheld[NALARMS];
+static long long lastsent[NALARMS];
+static char fakemsgs[NOTIFYFAKEMAX][NOTIFYMSGSZ];
+static int nfake;
+
+/** Adds a sink: exec:command, unix:/socket, file:/path or
+ * fake[:failevery[:delayms]]
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param spec sink description
+ * @return 1 if successful, 0 if the spec is malformed or there are too many sinks
+ */
+int GhNotifyAddSink(const char * spec) {
+	const char * kinds[] = { "exec:", "unix:", "file:" };
+	notifysink_s * s;
+
+	if (nsinks == NOTIFYSINKS || nrunning) {
+		return 0;
+	}
+	s = &sinks[nsinks];
+	memset(s, 0, sizeof(notifysink_s));
+	if (strncmp(spec, "fake", 4) == 0) {
+		s->kind = NOTIFYFAKE;
+		sscanf(spec, "fake:%d:%d", &s->failevery, &s->delayms);
+		nsinks++;
+		return 1;
+	}
+	for (int k = NOTIFYEXEC; k <= NOTIFYFILE; k++) {
+		if (strncmp(spec, kinds[k], 5) == 0 && spec[5] != '\0') {
+			s->kind = k;
+			snprintf(s->target, sizeof(s->target), "%s", spec + 5);
+			nsinks++;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/** Queues an alarm transition, folding it into a notice for the same code
+ * still waiting. Never blocks on delivery.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param code alarm code
+ * @param raised 1 when the alarm was raised, 0 when it cleared
+ * @param atime time of the transition
+ * @param value reading that caused it
+ */
+void GhNotifyPost(alarm_e code, int raised, time_t atime, double value) {
+	notice_s * n = NULL;
+
+	if (!nrunning) {
+		return;
+	}
+	pthread_mutex_lock(&nlock);
+	nstats.posted++;
+	for (int i = 0; i < qlen; i++) {
+		if (queue[(qhead + i) % NOTIFYQUEUE].code == code) {
+			n = &queue[(qhead + i) % NOTIFYQUEUE];
+			nstats.coalesced++;
+			break;
+		}
+	}
+	if (n == NULL && qlen < NOTIFYQUEUE) {
+		n = &queue[(qhead + qlen++) % NOTIFYQUEUE];
+		n->code = code;
+		n->count = 0;
+	}
+	if (n != NULL) {
+		n->raised = raised;
+		n->atime = atime;
+		n->value = value;
+		n->count++;
+		pthread_cond_signal(&ncond);
+	}
+	else {
+		nstats.dropped++;
+	}
+	pthread_mutex_unlock(&nlock);
+}
+
+/** Sleeps the worker
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhNotifySleep(int milliseconds) {
+	struct timespec ts = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L };
+	while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+	}
+}
+
+/** Runs a shell command with the notice in its environment
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if it exited with status 0 within NOTIFYTIMEOUT
+ */
+static int GhNotifyExec(notifysink_s * s, const notice_s * n, const char * msg) {
+	char env[6][NOTIFYMSGSZ + 16];
+	char * envp[7];
+	char * argv[] = { "sh", "-c", s->target, NULL };
+	const char * path = getenv("PATH");
+	posix_spawnattr_t attr;
+	sigset_t none;
+	int status, err, waited = 0;
+	pid_t pid, r;
+
+	// posix_spawn shares the parent's memory until exec instead of copying
+	// its page tables as fork would, which write protects every page of a
+	// locked real-time process and makes the control thread fault on them
+	snprintf(env[0], sizeof(env[0]), "GH_ALARM=%s", alarmnames[n->code]);
+	snprintf(env[1], sizeof(env[1]), "GH_STATE=%s", n->raised ? "raised" : "cleared");
+	snprintf(env[2], sizeof(env[2]), "GH_VALUE=%.1lf", n->value);
+	snprintf(env[3], sizeof(env[3]), "GH_TIME=%ld", (long) n->atime);
+	snprintf(env[4], sizeof(env[4]), "GH_COUNT=%ld", n->count);
+	snprintf(env[5], sizeof(env[5]), "PATH=%s", path != NULL ? path : "/usr/bin:/bin");
+	for (int i = 0; i < 6; i++) {
+		envp[i] = env[i];
+	}
+	envp[6] = NULL;
+	sigemptyset(&none);
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setsigmask(&attr, &none);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+	err = posix_spawn(&pid, "/bin/sh", NULL, &attr, argv, envp);
+	posix_spawnattr_destroy(&attr);
+	if (err != 0) {
+		return 0;
+	}
+	while ((r = waitpid(pid, &status, WNOHANG)) == 0 && waited < NOTIFYTIMEOUT) {
+		GhNotifySleep(10);
+		waited += 10;
+	}
+	if (r == 0) {
+		kill(pid, SIGKILL);
+		waitpid(pid, &status, 0);
+		return 0;
+	}
+	return r == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/** Writes the message to a local stream socket
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if the whole message was sent
+ */
+static int GhNotifyUnix(notifysink_s * s, const char * msg) {
+	struct sockaddr_un addr = {0};
+	struct timeval tv = { NOTIFYTIMEOUT / 1000, (NOTIFYTIMEOUT % 1000) * 1000 };
+	size_t len = strlen(msg);
+	int fd, ok;
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd == -1) {
+		return 0;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, s->target, sizeof(addr.sun_path) - 1);
+	ok = connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0
+		&& send(fd, msg, len, MSG_NOSIGNAL) == (ssize_t) len;
+	close(fd);
+	return ok;
+}
+
+/** Appends the message to a file
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if the whole message was written
+ */
+static int GhNotifyFile(notifysink_s * s, const char * msg) {
+	size_t len = strlen(msg);
+	int fd, ok;
+
+	fd = open(s->target, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		return 0;
+	}
+	ok = write(fd, msg, len) == (ssize_t) len;
+	close(fd);
+	return ok;
+}
+
+/** Keeps the message in memory, failing or taking time on request
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 0 on every failevery-th attempt, 1 otherwise
+ */
+static int GhNotifyFake(notifysink_s * s, const char * msg) {
+	if (s->delayms > 0) {
+		GhNotifySleep(s->delayms);
+	}
+	if (s->failevery > 0 && s->attempts % s->failevery == 0) {
+		return 0;
+	}
+	if (nfake < NOTIFYFAKEMAX) {
+		snprintf(fakemsgs[nfake++], NOTIFYMSGSZ, "%s", msg);
+	}
+	return 1;
+}
+
+/** Delivers a notice to every sink, retrying each with backoff
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhNotifyDeliver(const notice_s * n) {
+	char msg[NOTIFYMSGSZ];
+	int ok, all = 1, backoff;
+	notifysink_s * s;
+
+	snprintf(msg, sizeof(msg), "%ld,%s,%s,%.1lf,%ld\n", (long) n->atime, alarmnames[n->code],
+		n->raised ? "raised" : "cleared", n->value, n->count);
+	for (int i = 0; i < nsinks; i++) {
+		s = &sinks[i];
+		backoff = NOTIFYBACKOFF;
+		for (int attempt = 0; ; attempt++) {
+			s->attempts++;
+			switch (s->kind) {
+			case NOTIFYEXEC:
+				ok = GhNotifyExec(s, n, msg);
+				break;
+			case NOTIFYUNIX:
+				ok = GhNotifyUnix(s, msg);
+				break;
+			case NOTIFYFILE:
+				ok = GhNotifyFile(s, msg);
+				break;
+			default:
+				ok = GhNotifyFake(s, msg);
+				break;
+			}
+			if (ok || attempt == NOTIFYRETRIES || (nstop && GhRealClock.millis() >= ndeadline)) {
+				break;
+			}
+			pthread_mutex_lock(&nlock);
+			nstats.retries++;
+			pthread_mutex_unlock(&nlock);
+			GhNotifySleep(backoff);
+			backoff *= 2;
+		}
+		if (ok) {
+			s->delivered++;
+		}
+		else {
+			s->failed++;
+			all = 0;
+		}
+	}
+	pthread_mutex_lock(&nlock);
+	if (all) {
+		nstats.delivered++;
+	}
+	else {
+		nstats.failed++;
+	}
+	pthread_mutex_unlock(&nlock);
+}
+
+/** Worker: folds queued transitions per code and delivers each code when
+ * its rate limit allows, everything at once when stopping
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void * GhNotifyWorker(void * arg) {
+	struct timespec ts;
+	notice_s * q, n;
+	long long now, wait;
+	int code, anyheld;
+	sigset_t all;
+
+	// Signals belong to the control loop, and in real-time mode so do the
+	// core and the SCHED_FIFO policy this thread would otherwise inherit
+	sigfillset(&all);
+	pthread_sigmask(SIG_BLOCK, &all, NULL);
+	GhRtRelease();
+	pthread_mutex_lock(&nlock);
+	for (;;) {
+		now = GhRealClock.millis();
+		while (qlen > 0) {
+			q = &queue[qhead];
+			qhead = (qhead + 1) % NOTIFYQUEUE;
+			qlen--;
+			if (isheld[q->code]) {
+				q->count += held[q->code].count;
+				nstats.coalesced++;
+			}
+			else if (lastsent[q->code] != 0 && now - lastsent[q->code] < NOTIFYRATE * 1000LL) {
+				nstats.limited++;
+			}
+			held[q->code] = *q;
+			isheld[q->code] = 1;
+		}
+		code = -1;
+		anyheld = 0;
+		wait = NOTIFYRATE * 1000LL;
+		for (int c = 0; c < NALARMS; c++) {
+			if (!isheld[c]) {
+				continue;
+			}
+			anyheld = 1;
+			if (nstop || lastsent[c] == 0 || now - lastsent[c] >= NOTIFYRATE * 1000LL) {
+				code = c;
+				break;
+			}
+			if (lastsent[c] + NOTIFYRATE * 1000LL - now < wait) {
+				wait = lastsent[c] + NOTIFYRATE * 1000LL - now;
+			}
+		}
+		if (code == -1) {
+			if (nstop && !anyheld) {
+				break;
+			}
+			if (anyheld) {
+				clock_gettime(CLOCK_REALTIME, &ts);
+				ts.tv_sec += wait / 1000;
+				ts.tv_nsec += (wait % 1000) * 1000000L;
+				if (ts.tv_nsec >= 1000000000L) {
+					ts.tv_sec++;
+					ts.tv_nsec -= 1000000000L;
+				}
+				pthread_cond_timedwait(&ncond, &nlock, &ts);
+			}
+			else {
+				pthread_cond_wait(&ncond, &nlock);
+			}
+			continue;
+		}
+		n = held[code];
+		isheld[code] = 0;
+		lastsent[code] = now;
+		pthread_mutex_unlock(&nlock);
+		GhNotifyDeliver(&n);
+		pthread_mutex_lock(&nlock);
+	}
+	pthread_mutex_unlock(&nlock);
+	return NULL;
+}
+
+/** Starts the worker if any sink was added
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if running, 0 without sinks or on error
+ */
+int GhNotifyStart(void) {
+	if (nsinks == 0 || nrunning) {
+		return nrunning;
+	}
+	nstop = 0;
+	if (pthread_create(&nthread, NULL, GhNotifyWorker, NULL) != 0) {
+		return 0;
+	}
+	nrunning = 1;
+	return 1;
+}
+
+/** Delivers what is pending, within NOTIFYDRAIN, and stops the worker
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhNotifyStop(void) {
+	if (!nrunning) {
+		return;
+	}
+	pthread_mutex_lock(&nlock);
+	nstop = 1;
+	ndeadline = GhRealClock.millis() + NOTIFYDRAIN;
+	pthread_cond_signal(&ncond);
+	pthread_mutex_unlock(&nlock);
+	pthread_join(nthread, NULL);
+	nrunning = 0;
+}
+
+/** Gets dispatcher counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return counters
+ */
+notifystats_s GhNotifyStats(void) {
+	notifystats_s s;
+	pthread_mutex_lock(&nlock);
+	s = nstats;
+	pthread_mutex_unlock(&nlock);
+	return s;
+}
+
+/** Prints dispatcher and sink counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ */
+void GhNotifyReport(FILE * fp) {
+	const char kinds[4][5] = { "exec", "unix", "file", "fake" };
+	notifystats_s s = GhNotifyStats();
+
+	if (nsinks == 0) {
+		return;
+	}
+	fprintf(fp, "Notify: %ld posted, %ld coalesced, %ld dropped, %ld rate limited, "
+		"%ld delivered, %ld retries, %ld failed\n",
+		s.posted, s.coalesced, s.dropped, s.limited, s.delivered, s.retries, s.failed);
+	for (int i = 0; i < nsinks; i++) {
+		fprintf(fp, "  %s %s: %ld attempts, %ld delivered, %ld failed\n", kinds[sinks[i].kind],
+			sinks[i].target, sinks[i].attempts, sinks[i].delivered, sinks[i].failed);
+	}
+}
+
+/** Gets the number of messages the fake sink kept
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return messages, read after GhNotifyStop
+ */
+int GhNotifyFakeCount(void) {
+	return nfake;
+}
+
+/** Gets a message the fake sink kept
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param i 0 to GhNotifyFakeCount() - 1
+ * @return message line
+ */
+const char * GhNotifyFakeMessage(int i) {
+	return fakemsgs[i];
+}
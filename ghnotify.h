@@ -0,0 +1,67 @@
+/** Alarm notification constants, structures, function prototypes
+ * @version ghnotify.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHNOTIFY_H
+#define GHNOTIFY_H
+
+#include <pthread.h>
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define NOTIFYQUEUE 64          // transitions waiting for the worker
+#define NOTIFYSINKS 8
+#define NOTIFYTARGETSZ 128
+#define NOTIFYMSGSZ 160
+#define NOTIFYRATE 60           // seconds between deliveries of one code
+#define NOTIFYRETRIES 4         // attempts after the first before a sink gives up
+#define NOTIFYBACKOFF 250       // ms before the first retry, doubling
+#define NOTIFYTIMEOUT 5000      // ms an exec or socket sink may take
+#define NOTIFYDRAIN 2000        // ms GhNotifyStop waits for the queue to empty
+#define NOTIFYFAKEMAX 1024      // messages the fake sink keeps
+#define NOTIFYEXEC 0            // sink kinds
+#define NOTIFYUNIX 1
+#define NOTIFYFILE 2
+#define NOTIFYFAKE 3
+
+// Structures ##########################################
+typedef struct notice {
+	alarm_e code;
+	int raised;             // state after the last transition
+	time_t atime;           // time of the last transition
+	double value;
+	long count;             // transitions folded into this notice
+}notice_s;
+
+typedef struct notifysink {
+	int kind;
+	char target[NOTIFYTARGETSZ];
+	int failevery;          // fake: fail every nth delivery, 0 never
+	int delayms;            // fake: time each delivery takes
+	long attempts;
+	long delivered;
+	long failed;
+}notifysink_s;
+
+typedef struct notifystats {
+	long posted;            // transitions handed to GhNotifyPost
+	long coalesced;         // folded into a notice already waiting
+	long dropped;           // lost to a full queue
+	long limited;           // held back by the per code rate limit
+	long delivered;         // notices every sink took
+	long retries;
+	long failed;            // notices a sink gave up on
+}notifystats_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhNotifyAddSink(const char * spec);
+int GhNotifyStart(void);
+void GhNotifyPost(alarm_e code, int raised, time_t atime, double value);
+void GhNotifyStop(void);
+notifystats_s GhNotifyStats(void);
+void GhNotifyReport(FILE * fp);
+int GhNotifyFakeCount(void);
+const char * GhNotifyFakeMessage(int i);
+/// @endcond
+#endif
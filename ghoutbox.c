@@ -0,0 +1,482 @@
+/** Store and forward outbox functions
+ * An append only write ahead log of everything that has to leave the
+ * device. Appends only ever go to the page cache, writeback is started
+ * without waiting for it, so the control loop is never held up by the
+ * disk. The cursor is replaced atomically by rename; losing it to a crash
+ * replays records the collector may already have, which the fleet client
+ * stores with their frame's sequence number so they are resent as the
+ * same frames and dropped as duplicates.
+ * @version ghoutbox.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ghoutbox.h"
+#include "ghcrc.h"
+#include "ghclock.h"
+
+static char odir[OUTBOXPATHSZ];
+static int ofd = -1;                // head segment, opened for appending
+static int rfd = -1;                // segment being replayed
+static uint32_t rseg;
+static uint32_t otail;              // oldest segment on disk
+static outboxpos_s ohead;           // end of the last record
+static outboxpos_s ocursor;         // end of the last acknowledged record
+static int odirty;                  // cursor moved since it was written
+static long long ocursorms;         // real ms the cursor file was written
+static long long osyncms;           // real ms writeback was last started
+static outboxstats_s ostats;
+
+/** Builds the path of a file in the outbox directory
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhOutboxPath(char * path, uint32_t seg, const char * name) {
+	if (name != NULL) {
+		snprintf(path, OUTBOXPATHSZ + 32, "%s/%s", odir, name);
+	}
+	else {
+		snprintf(path, OUTBOXPATHSZ + 32, "%s/%08u.seg", odir, seg);
+	}
+}
+
+/** Stores a little endian 32 bit value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhOutboxPut32(uint8_t * p, uint32_t v) {
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+	p[2] = (v >> 16) & 0xFF;
+	p[3] = v >> 24;
+}
+
+/** Loads a little endian 32 bit value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static uint32_t GhOutboxGet32(const uint8_t * p) {
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/** Checks the record at the start of buf
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param buf bytes read from a segment
+ * @param avail number of bytes in buf
+ * @return record size with its header, 0 if incomplete, -1 if corrupt
+ */
+static int GhOutboxCheck(const uint8_t * buf, size_t avail) {
+	uint32_t len;
+
+	if (avail < OUTBOXHDRSZ) {
+		return 0;
+	}
+	len = GhOutboxGet32(buf);
+	if (len == 0 || len > OUTBOXRECMAX) {
+		return -1;
+	}
+	if (avail < OUTBOXHDRSZ + len) {
+		return 0;
+	}
+	if (GhCrc32(GhCrc32(0, buf, 4), buf + OUTBOXHDRSZ, len) != GhOutboxGet32(buf + 4)) {
+		return -1;
+	}
+	return OUTBOXHDRSZ + len;
+}
+
+/** Writes the cursor file through a temporary file and rename
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhOutboxWriteCursor(void) {
+	char tmp[OUTBOXPATHSZ + 32], path[OUTBOXPATHSZ + 32];
+	uint8_t buf[12];
+	int fd;
+
+	GhOutboxPut32(buf, ocursor.seg);
+	GhOutboxPut32(buf + 4, ocursor.off);
+	GhOutboxPut32(buf + 8, GhCrc32(0, buf, 8));
+	GhOutboxPath(tmp, 0, OUTBOXCURSOR ".tmp");
+	GhOutboxPath(path, 0, OUTBOXCURSOR);
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		return;
+	}
+	if (write(fd, buf, sizeof(buf)) == sizeof(buf)) {
+		rename(tmp, path);
+	}
+	close(fd);
+	odirty = 0;
+	ocursorms = GhRealClock.millis();
+}
+
+/** Reads the cursor file
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if a valid cursor was read
+ */
+static int GhOutboxReadCursor(void) {
+	char path[OUTBOXPATHSZ + 32];
+	uint8_t buf[12];
+	int fd, n;
+
+	GhOutboxPath(path, 0, OUTBOXCURSOR);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		return 0;
+	}
+	n = read(fd, buf, sizeof(buf));
+	close(fd);
+	if (n != sizeof(buf) || GhCrc32(0, buf, 8) != GhOutboxGet32(buf + 8)) {
+		return 0;
+	}
+	ocursor.seg = GhOutboxGet32(buf);
+	ocursor.off = GhOutboxGet32(buf + 4);
+	return 1;
+}
+
+/** Finds the end of the last whole record of the head segment and cuts
+ * off anything torn by a crash
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful
+ */
+static int GhOutboxRecover(void) {
+	static uint8_t chunk[1 << 16];
+	char path[OUTBOXPATHSZ + 32];
+	size_t avail = 0, used;
+	ssize_t n;
+	uint32_t off = 0;
+	int fd, rlen;
+
+	GhOutboxPath(path, ohead.seg, NULL);
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		return 0;
+	}
+	for (;;) {
+		n = pread(fd, chunk + avail, sizeof(chunk) - avail, off + avail);
+		if (n <= 0) {
+			break;
+		}
+		avail += n;
+		used = 0;
+		while ((rlen = GhOutboxCheck(chunk + used, avail - used)) > 0) {
+			used += rlen;
+		}
+		off += used;
+		memmove(chunk, chunk + used, avail - used);
+		avail -= used;
+		if (rlen < 0) {
+			break;
+		}
+	}
+	if (ftruncate(fd, off) == -1) {
+		close(fd);
+		return 0;
+	}
+	close(fd);
+	ohead.off = off;
+	return 1;
+}
+
+/** Opens the outbox in a directory, recovering it after a crash
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dir directory of the segment and cursor files, created if needed
+ * @return 1 if successful, 0 on error
+ */
+int GhOutboxOpen(const char * dir) {
+	char path[OUTBOXPATHSZ + 32];
+	struct dirent * de;
+	unsigned int seg;
+	int found = 0;
+	DIR * d;
+
+	snprintf(odir, sizeof(odir), "%s", dir);
+	mkdir(odir, 0755);
+	d = opendir(odir);
+	if (d == NULL) {
+		return 0;
+	}
+	otail = ohead.seg = 0;
+	while ((de = readdir(d)) != NULL) {
+		if (strlen(de->d_name) != 12 || sscanf(de->d_name, "%8u.seg", &seg) != 1) {
+			continue;
+		}
+		if (!found || seg < otail) {
+			otail = seg;
+		}
+		if (!found || seg > ohead.seg) {
+			ohead.seg = seg;
+		}
+		found = 1;
+	}
+	closedir(d);
+	if (!GhOutboxRecover()) {
+		return 0;
+	}
+	if (!GhOutboxReadCursor() || ocursor.seg > ohead.seg
+			|| (ocursor.seg == ohead.seg && ocursor.off > ohead.off)) {
+		ocursor.seg = otail;
+		ocursor.off = 0;
+	}
+	if (ocursor.seg < otail) {
+		ocursor.seg = otail;
+		ocursor.off = 0;
+	}
+	GhOutboxPath(path, ohead.seg, NULL);
+	ofd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	memset(&ostats, 0, sizeof(ostats));
+	GhOutboxWriteCursor();
+	return ofd != -1;
+}
+
+/** Writes the cursor and closes the outbox
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhOutboxClose(void) {
+	if (ofd == -1) {
+		return;
+	}
+	GhOutboxWriteCursor();
+	close(ofd);
+	ofd = -1;
+	if (rfd != -1) {
+		close(rfd);
+	}
+	rfd = -1;
+}
+
+/** Deletes the oldest segment
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhOutboxDropTail(void) {
+	char path[OUTBOXPATHSZ + 32];
+
+	GhOutboxPath(path, otail, NULL);
+	unlink(path);
+	if (rfd != -1 && rseg == otail) {
+		close(rfd);
+		rfd = -1;
+	}
+	otail++;
+}
+
+/** Starts a new head segment, evicting the oldest beyond OUTBOXSEGS
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful
+ */
+static int GhOutboxRoll(void) {
+	char path[OUTBOXPATHSZ + 32];
+
+	sync_file_range(ofd, 0, 0, SYNC_FILE_RANGE_WRITE);
+	close(ofd);
+	ohead.seg++;
+	ohead.off = 0;
+	GhOutboxPath(path, ohead.seg, NULL);
+	ofd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	while (ohead.seg - otail + 1 > OUTBOXSEGS) {
+		if (ocursor.seg <= otail) {
+			// Unsent records go: the newest data is worth more
+			ocursor.seg = otail + 1;
+			ocursor.off = 0;
+			odirty = 1;
+			ostats.evicted++;
+		}
+		GhOutboxDropTail();
+	}
+	if (odirty) {
+		GhOutboxWriteCursor();
+	}
+	return ofd != -1;
+}
+
+/** Appends a record
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param payload bytes of the record
+ * @param len 1 to OUTBOXRECMAX
+ * @return 1 if successful, 0 if the record was not stored
+ */
+int GhOutboxAppend(const void * payload, uint32_t len) {
+	uint8_t buf[OUTBOXHDRSZ + OUTBOXRECMAX];
+	ssize_t n;
+
+	if (ofd == -1 || len == 0 || len > OUTBOXRECMAX) {
+		ostats.failed++;
+		return 0;
+	}
+	if (ohead.off > 0 && ohead.off + OUTBOXHDRSZ + len > OUTBOXSEGSZ && !GhOutboxRoll()) {
+		ostats.failed++;
+		return 0;
+	}
+	GhOutboxPut32(buf, len);
+	memcpy(buf + OUTBOXHDRSZ, payload, len);
+	GhOutboxPut32(buf + 4, GhCrc32(GhCrc32(0, buf, 4), payload, len));
+	n = write(ofd, buf, OUTBOXHDRSZ + len);
+	if (n != (ssize_t)(OUTBOXHDRSZ + len)) {
+		// Disk full: do not leave a torn record in front of later ones
+		if (n > 0 && ftruncate(ofd, ohead.off) == -1) {
+			ohead.off += n;
+			GhOutboxRoll();
+		}
+		ostats.failed++;
+		return 0;
+	}
+	ohead.off += n;
+	ostats.appended++;
+	return 1;
+}
+
+/** Reads records of one size onward from a position
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pos where to start, moved past the records read
+ * @param buf receives the payloads back to back
+ * @param recsz payload size, records of any other size are skipped
+ * @param maxrecs most records to read
+ * @return number of records read, 0 once pos reaches the head
+ */
+int GhOutboxRead(outboxpos_s * pos, uint8_t * buf, uint32_t recsz, int maxrecs) {
+	static uint8_t chunk[1 << 16];
+	char path[OUTBOXPATHSZ + 32];
+	size_t want, used;
+	ssize_t got;
+	int n = 0, rlen = 0;
+
+	while (n < maxrecs && GhOutboxPending(*pos)) {
+		if (pos->seg < otail) {
+			pos->seg = otail;
+			pos->off = 0;
+		}
+		if (rfd == -1 || rseg != pos->seg) {
+			if (rfd != -1) {
+				close(rfd);
+			}
+			GhOutboxPath(path, pos->seg, NULL);
+			rfd = open(path, O_RDONLY | O_CLOEXEC);
+			rseg = pos->seg;
+			if (rfd == -1) {
+				pos->seg++;
+				pos->off = 0;
+				continue;
+			}
+		}
+		want = (size_t)(maxrecs - n) * (OUTBOXHDRSZ + recsz);
+		if (want < OUTBOXHDRSZ + OUTBOXRECMAX) {
+			want = OUTBOXHDRSZ + OUTBOXRECMAX;
+		}
+		got = pread(rfd, chunk, want < sizeof(chunk) ? want : sizeof(chunk), pos->off);
+		used = 0;
+		while (got > 0 && n < maxrecs && (rlen = GhOutboxCheck(chunk + used, got - used)) > 0) {
+			if ((uint32_t) rlen == OUTBOXHDRSZ + recsz) {
+				memcpy(buf + (size_t) n * recsz, chunk + used + OUTBOXHDRSZ, recsz);
+				n++;
+			}
+			else {
+				ostats.corrupt++;
+			}
+			used += rlen;
+		}
+		pos->off += used;
+		if (used > 0) {
+			continue;
+		}
+		if (got > 0) {
+			// Damage or a torn tail: nothing after it can be trusted
+			ostats.corrupt++;
+		}
+		if (pos->seg == ohead.seg) {
+			*pos = ohead;
+			break;
+		}
+		pos->seg++;
+		pos->off = 0;
+	}
+	return n;
+}
+
+/** Gets the acknowledged position
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return cursor
+ */
+outboxpos_s GhOutboxCursor(void) {
+	if (ocursor.seg < otail) {
+		ocursor.seg = otail;
+		ocursor.off = 0;
+	}
+	return ocursor;
+}
+
+/** Moves the cursor after the upstream acknowledged everything before pos
+ * Fully acknowledged segments are deleted, the cursor file is rewritten
+ * at most every OUTBOXCURSORMS.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pos end of the last acknowledged record
+ */
+void GhOutboxAck(outboxpos_s pos) {
+	if (pos.seg < ocursor.seg || (pos.seg == ocursor.seg && pos.off <= ocursor.off)) {
+		return;
+	}
+	ocursor = pos;
+	odirty = 1;
+	while (otail < ocursor.seg) {
+		GhOutboxDropTail();
+	}
+	if (GhRealClock.millis() - ocursorms >= OUTBOXCURSORMS) {
+		GhOutboxWriteCursor();
+	}
+}
+
+/** Checks whether records were appended after a position
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pos position to check
+ * @return 1 if pos is before the head
+ */
+int GhOutboxPending(outboxpos_s pos) {
+	return pos.seg < ohead.seg || (pos.seg == ohead.seg && pos.off < ohead.off);
+}
+
+/** Starts writeback of the head segment and writes a moved cursor, at
+ * most every OUTBOXCURSORMS
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhOutboxSync(void) {
+	long long ms = GhRealClock.millis();
+
+	if (ofd == -1 || ms - osyncms < OUTBOXCURSORMS) {
+		return;
+	}
+	osyncms = ms;
+	sync_file_range(ofd, 0, 0, SYNC_FILE_RANGE_WRITE);
+	if (odirty) {
+		GhOutboxWriteCursor();
+	}
+}
+
+/** Gets outbox counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return counters
+ */
+outboxstats_s GhOutboxStats(void) {
+	outboxpos_s c = GhOutboxCursor();
+	ostats.segments = ohead.seg - otail + 1;
+	ostats.pending = (long long)(ohead.seg - c.seg) * OUTBOXSEGSZ + ohead.off - c.off;
+	return ostats;
+}
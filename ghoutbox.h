@@ -0,0 +1,50 @@
+/** Store and forward outbox constants, structures, function prototypes
+ * Records are appended to numbered segment files in a directory, each a
+ * 32 bit length and CRC-32 followed by the payload. A cursor file holds
+ * the position up to which the upstream has acknowledged.
+ * @version ghoutbox.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHOUTBOX_H
+#define GHOUTBOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Constants ##############################################
+#define OUTBOXSEGSZ (1 << 20)   // bytes before a new segment is started
+#define OUTBOXSEGS 64           // segments kept, the oldest is evicted beyond this
+#define OUTBOXHDRSZ 8           // length and CRC before every payload
+#define OUTBOXRECMAX 256        // largest payload
+#define OUTBOXCURSORMS 1000     // least real ms between cursor file writes
+#define OUTBOXPATHSZ 192
+#define OUTBOXCURSOR "cursor"
+
+// Structures ##########################################
+typedef struct outboxpos {
+	uint32_t seg;
+	uint32_t off;
+}outboxpos_s;
+
+typedef struct outboxstats {
+	long appended;          // records appended since open
+	long failed;            // appends the disk refused
+	long evicted;           // segments dropped unsent to bound the disk
+	long corrupt;           // records skipped on a bad length or CRC
+	long segments;          // segment files on disk
+	long long pending;      // bytes not yet acknowledged
+}outboxstats_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhOutboxOpen(const char * dir);
+void GhOutboxClose(void);
+int GhOutboxAppend(const void * payload, uint32_t len);
+int GhOutboxRead(outboxpos_s * pos, uint8_t * buf, uint32_t recsz, int maxrecs);
+outboxpos_s GhOutboxCursor(void);
+void GhOutboxAck(outboxpos_s pos);
+int GhOutboxPending(outboxpos_s pos);
+void GhOutboxSync(void);
+outboxstats_s GhOutboxStats(void);
+/// @endcond
+#endif
@@ -0,0 +1,176 @@
+/** Greenhouse plant simulator functions
+ * Lumped model of one greenhouse: a single air temperature and relative
+ * humidity exchanging with an outdoor weather profile through first order
+ * time constants, driven by the heater and humidifier outputs.
+ * @version ghplant.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <math.h>
+#include <string.h>
+#include "ghplant.h"
+
+static const weather_s profiles[PLANTPROFILES] = {
+	{ "temperate", 9.0, 10.0, 5.0, 75.0, 15.0, 1013.0, 12.0, 4.0 },
+	{ "winter", -4.0, 3.0, 4.0, 85.0, 8.0, 1018.0, 15.0, 5.0 },
+	{ "summer", 24.0, 3.0, 7.0, 55.0, 20.0, 1010.0, 6.0, 6.0 },
+	{ "arid", 20.0, 9.0, 12.0, 25.0, 12.0, 1005.0, 4.0, 7.0 }
+};
+static plant_s gp;
+
+/** Outdoor temperature at a point in time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param t simulated seconds since the epoch
+ * @return temperature C, coldest at the end of January and before dawn
+ */
+static double GhPlantOutdoorT(double t) {
+	double day = fmod(t / 86400.0, 365.25);
+	double hour = fmod(t / 3600.0, 24.0);
+	return gp.wx.tmean - gp.wx.tseason * cos(2.0 * M_PI * (day - 30.0) / 365.25)
+		- gp.wx.tdaily * cos(2.0 * M_PI * (hour - 3.0) / 24.0);
+}
+
+/** Outdoor relative humidity at a point in time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param t simulated seconds since the epoch
+ * @return relative humidity %, highest before dawn
+ */
+static double GhPlantOutdoorH(double t) {
+	double hour = fmod(t / 3600.0, 24.0);
+	return gp.wx.hmean + gp.wx.hdaily * cos(2.0 * M_PI * (hour - 4.0) / 24.0);
+}
+
+/** Outdoor pressure at a point in time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param t simulated seconds since the epoch
+ * @return pressure hPa, swinging over the profile's weather period
+ */
+static double GhPlantOutdoorP(double t) {
+	return gp.wx.pmean + gp.wx.pswing * sin(2.0 * M_PI * t / (gp.wx.pdays * 86400.0));
+}
+
+/** Small zero mean sensor noise
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return value in -PLANTNOISE..PLANTNOISE, roughly bell shaped
+ */
+static double GhPlantNoise(void) {
+	double sum = 0;
+	for (int i = 0; i < 3; i++) {
+		gp.seed = gp.seed * 1103515245u + 12345u;
+		sum += ((gp.seed >> 8) & 0xFFFF) / 65535.0 - 0.5;
+	}
+	return sum * 2.0 / 3.0 * PLANTNOISE;
+}
+
+/** Selects a weather profile and resets the plant
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param profile name of a weather profile
+ * @param start simulated time the plant starts at
+ * @return 1 if successful, 0 for an unknown profile
+ */
+int GhPlantInit(const char * profile, time_t start) {
+	for (int i = 0; i < PLANTPROFILES; i++) {
+		if (strcmp(profiles[i].name, profile) == 0) {
+			memset(&gp, 0, sizeof(gp));
+			gp.wx = profiles[i];
+			gp.t = (double) start;
+			gp.t0 = gp.t;
+			gp.temperature = GhPlantOutdoorT(gp.t);
+			gp.humidity = GhPlantOutdoorH(gp.t);
+			gp.pressure = GhPlantOutdoorP(gp.t);
+			gp.tmin = gp.tmax = gp.temperature;
+			gp.hmin = gp.hmax = gp.humidity;
+			gp.seed = (unsigned int) start;
+			return 1;
+		}
+	}
+	fprintf(stdout, "\nUnknown weather profile %s, use:", profile);
+	for (int i = 0; i < PLANTPROFILES; i++) {
+		fprintf(stdout, " %s", profiles[i].name);
+	}
+	fprintf(stdout, "\n");
+	return 0;
+}
+
+/** Integrates the plant up to a point in time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now simulated time to advance to, earlier times are ignored
+ */
+void GhPlantStep(time_t now) {
+	double dt, dtemp, hout;
+
+	while (gp.t < (double) now) {
+		dt = fmin(PLANTSTEP, (double) now - gp.t);
+		dtemp = (GhPlantOutdoorT(gp.t) - gp.temperature) * dt / PLANTTAUT
+			+ gp.heater * PLANTHEAT * dt / 3600.0;
+		hout = GhPlantOutdoorH(gp.t);
+		gp.temperature += dtemp;
+		gp.humidity += (hout - gp.humidity) * dt / PLANTTAUH
+			+ gp.humidifier * PLANTHUMID * dt / 3600.0 - PLANTRHPERC * dtemp;
+		gp.humidity = fmax(0.0, fmin(100.0, gp.humidity));
+		gp.pressure = GhPlantOutdoorP(gp.t);
+		gp.heateron += gp.heater * dt;
+		gp.humidon += gp.humidifier * dt;
+		gp.t += dt;
+		gp.tmin = fmin(gp.tmin, gp.temperature);
+		gp.tmax = fmax(gp.tmax, gp.temperature);
+		gp.hmin = fmin(gp.hmin, gp.humidity);
+		gp.hmax = fmax(gp.hmax, gp.humidity);
+	}
+}
+
+/** Applies the controller outputs from now on
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param heater ON or OFF
+ * @param humidifier ON or OFF
+ */
+void GhPlantActuate(int heater, int humidifier) {
+	gp.heater = heater != 0;
+	gp.humidifier = humidifier != 0;
+}
+
+/** Gets the measured greenhouse temperature
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return temperature C including sensor noise
+ */
+double GhPlantTemperature(void) {
+	return gp.temperature + GhPlantNoise();
+}
+
+/** Gets the measured greenhouse humidity
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return relative humidity % including sensor noise
+ */
+double GhPlantHumidity(void) {
+	return fmax(0.0, fmin(100.0, gp.humidity + GhPlantNoise()));
+}
+
+/** Gets the measured station pressure
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return pressure mb including sensor noise
+ */
+double GhPlantPressure(void) {
+	return gp.pressure + GhPlantNoise();
+}
+
+/** Prints ranges and actuator duty since GhPlantInit
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ */
+void GhPlantReport(FILE * fp) {
+	double span = fmax(1.0, gp.t - gp.t0);
+	fprintf(fp, "Plant %s  T: %.1lf..%.1lfC  H: %.0lf..%.0lf%%  Heater on: %.0lf%%  Humidifier on: %.0lf%%\n",
+		gp.wx.name, gp.tmin, gp.tmax, gp.hmin, gp.hmax, 100.0 * gp.heateron / span, 100.0 * gp.humidon / span);
+}
+
+const ghsource_s GhPlantSource = { GhPlantStep, GhPlantActuate, GhPlantTemperature, GhPlantHumidity, GhPlantPressure };
@@ -0,0 +1,62 @@
+/** Greenhouse plant simulator constants, structures, function prototypes
+ * @version ghplant.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHPLANT_H
+#define GHPLANT_H
+
+#include <stdio.h>
+#include <time.h>
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define PLANTSTEP 60.0      // longest integration step in seconds
+#define PLANTTAUT 7200.0    // thermal time constant of the envelope in seconds
+#define PLANTTAUH 5400.0    // moisture exchange time constant in seconds
+#define PLANTHEAT 20.0      // heater gain in C per hour
+#define PLANTHUMID 30.0     // humidifier gain in %rH per hour
+#define PLANTRHPERC 4.5     // %rH lost per C of warming at constant moisture
+#define PLANTNOISE 0.1      // sensor noise amplitude
+#define PLANTPROFILES 4
+#define PLANTNMSZ 12
+
+// Structures ##########################################
+typedef struct weather {
+	char name[PLANTNMSZ];
+	double tmean;       // annual mean outdoor temperature C
+	double tseason;     // summer to annual mean swing C
+	double tdaily;      // afternoon to daily mean swing C
+	double hmean;       // mean outdoor relative humidity %
+	double hdaily;      // pre-dawn to daily mean swing %
+	double pmean;       // mean station pressure mb
+	double pswing;      // weather front swing mb
+	double pdays;       // weather front period in days
+}weather_s;
+
+typedef struct plant {
+	weather_s wx;
+	double temperature;
+	double humidity;
+	double pressure;
+	double t;           // simulated seconds since the epoch
+	double t0;          // time of GhPlantInit
+	int heater;
+	int humidifier;
+	double heateron;    // seconds the heater has been on
+	double humidon;     // seconds the humidifier has been on
+	double tmin, tmax, hmin, hmax;
+	unsigned int seed;
+}plant_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+extern const ghsource_s GhPlantSource;
+int GhPlantInit(const char * profile, time_t start);
+void GhPlantStep(time_t now);
+void GhPlantActuate(int heater, int humidifier);
+double GhPlantTemperature(void);
+double GhPlantHumidity(void);
+double GhPlantPressure(void);
+void GhPlantReport(FILE * fp);
+/// @endcond
+#endif
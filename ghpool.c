@@ -0,0 +1,239 @@
+/** Work stealing thread pool functions
+ * Every worker owns a deque. Submitted tasks are dealt round robin, a
+ * worker pops its own newest task first and steals the oldest task of
+ * another worker when it runs dry, so uneven tasks still keep every core
+ * busy.
+ * @version ghpool.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ghpool.h"
+
+/** Appends a task to the owner end of a deque
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful, 0 if memory ran out
+ */
+static int GhDequePush(ghdeque_s * dq, ghtask_s task) {
+	ghtask_s * grown;
+
+	pthread_mutex_lock(&dq->lock);
+	if (dq->tail - dq->head == dq->size) {
+		grown = calloc(dq->size * 2, sizeof(ghtask_s));
+		if (grown == NULL) {
+			pthread_mutex_unlock(&dq->lock);
+			return 0;
+		}
+		for (long i = dq->head; i < dq->tail; i++) {
+			grown[i % (dq->size * 2)] = dq->tasks[i % dq->size];
+		}
+		free(dq->tasks);
+		dq->tasks = grown;
+		dq->size *= 2;
+	}
+	dq->tasks[dq->tail % dq->size] = task;
+	dq->tail++;
+	pthread_mutex_unlock(&dq->lock);
+	return 1;
+}
+
+/** Takes a task from either end of a deque
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param dq deque
+ * @param task receives the task
+ * @param steal non zero takes the oldest task, zero the newest
+ * @return 1 if a task was taken, 0 if the deque was empty
+ */
+static int GhDequeTake(ghdeque_s * dq, ghtask_s * task, int steal) {
+	int got = 0;
+
+	pthread_mutex_lock(&dq->lock);
+	if (dq->tail > dq->head) {
+		if (steal) {
+			*task = dq->tasks[dq->head % dq->size];
+			dq->head++;
+		}
+		else {
+			dq->tail--;
+			*task = dq->tasks[dq->tail % dq->size];
+		}
+		got = 1;
+	}
+	pthread_mutex_unlock(&dq->lock);
+	return got;
+}
+
+/** Finds work for one worker, its own deque first
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if a task was found
+ */
+static int GhPoolFind(ghpool_s * pool, int id, ghtask_s * task) {
+	if (GhDequeTake(&pool->deques[id], task, 0)) {
+		return 1;
+	}
+	for (int i = 1; i < pool->nthreads; i++) {
+		if (GhDequeTake(&pool->deques[(id + i) % pool->nthreads], task, 1)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/** Worker thread body
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void * GhPoolWorker(void * arg) {
+	ghworker_s * w = arg;
+	ghpool_s * pool = w->pool;
+	ghtask_s task;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->queued == 0 && !pool->stop) {
+			pthread_cond_wait(&pool->work, &pool->lock);
+		}
+		if (pool->queued == 0 && pool->stop) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&pool->lock);
+
+		while (GhPoolFind(pool, w->id, &task)) {
+			pthread_mutex_lock(&pool->lock);
+			pool->queued--;
+			pthread_mutex_unlock(&pool->lock);
+			task.fn(task.arg);
+			pthread_mutex_lock(&pool->lock);
+			if (--pool->pending == 0) {
+				pthread_cond_broadcast(&pool->idle);
+			}
+			pthread_mutex_unlock(&pool->lock);
+		}
+	}
+}
+
+/** Stops the first started workers and frees a pool
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pool pool
+ * @param started workers running
+ * @param ndeques deques set up
+ */
+static void GhPoolFree(ghpool_s * pool, int started, int ndeques) {
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->work);
+	pthread_mutex_unlock(&pool->lock);
+	for (int i = 0; i < started; i++) {
+		pthread_join(pool->threads[i], NULL);
+	}
+	for (int i = 0; i < ndeques; i++) {
+		free(pool->deques[i].tasks);
+		pthread_mutex_destroy(&pool->deques[i].lock);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->work);
+	pthread_cond_destroy(&pool->idle);
+	free(pool);
+}
+
+/** Starts a pool
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param nthreads number of workers, 0 for one per online CPU
+ * @return pool, NULL on error
+ */
+ghpool_s * GhPoolCreate(int nthreads) {
+	ghpool_s * pool;
+
+	if (nthreads <= 0) {
+		nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (nthreads < 1) {
+		nthreads = 1;
+	}
+	if (nthreads > GHPOOLMAX) {
+		nthreads = GHPOOLMAX;
+	}
+	pool = calloc(1, sizeof(ghpool_s));
+	if (pool == NULL) {
+		return NULL;
+	}
+	pool->nthreads = nthreads;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work, NULL);
+	pthread_cond_init(&pool->idle, NULL);
+	for (int i = 0; i < nthreads; i++) {
+		pool->deques[i].size = GHDEQUEINIT;
+		pool->deques[i].tasks = calloc(GHDEQUEINIT, sizeof(ghtask_s));
+		if (pool->deques[i].tasks == NULL) {
+			GhPoolFree(pool, 0, i);
+			return NULL;
+		}
+		pthread_mutex_init(&pool->deques[i].lock, NULL);
+	}
+	for (int i = 0; i < nthreads; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].id = i;
+		if (pthread_create(&pool->threads[i], NULL, GhPoolWorker, &pool->workers[i]) != 0) {
+			GhPoolFree(pool, i, nthreads);
+			return NULL;
+		}
+	}
+	return pool;
+}
+
+/** Queues a task
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pool pool
+ * @param fn function to run on a worker
+ * @param arg argument handed to fn
+ * @return 1 if successful, 0 on error
+ */
+int GhPoolSubmit(ghpool_s * pool, ghtask_f fn, void * arg) {
+	ghtask_s task = { fn, arg };
+	int target;
+
+	// A worker may take the task as soon as it is pushed, but cannot count
+	// it off queued before it is counted in
+	pthread_mutex_lock(&pool->lock);
+	pool->next = (pool->next + 1) % pool->nthreads;
+	target = pool->next;
+	if (!GhDequePush(&pool->deques[target], task)) {
+		pthread_mutex_unlock(&pool->lock);
+		return 0;
+	}
+	pool->pending++;
+	pool->queued++;
+	pthread_cond_signal(&pool->work);
+	pthread_mutex_unlock(&pool->lock);
+	return 1;
+}
+
+/** Waits until every submitted task has finished
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pool pool
+ */
+void GhPoolWait(ghpool_s * pool) {
+	pthread_mutex_lock(&pool->lock);
+	while (pool->pending > 0) {
+		pthread_cond_wait(&pool->idle, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/** Finishes queued tasks, stops the workers and frees the pool
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param pool pool
+ */
+void GhPoolDestroy(ghpool_s * pool) {
+	GhPoolFree(pool, pool->nthreads, pool->nthreads);
+}
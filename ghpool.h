@@ -0,0 +1,56 @@
+/** Work stealing thread pool constants, structures, function prototypes
+ * @version ghpool.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHPOOL_H
+#define GHPOOL_H
+
+#include <pthread.h>
+
+// Constants ##############################################
+#define GHPOOLMAX 64        // most worker threads in one pool
+#define GHDEQUEINIT 256     // initial task slots per worker
+
+// Structures ##########################################
+typedef void (*ghtask_f)(void * arg);
+
+typedef struct ghtask {
+	ghtask_f fn;
+	void * arg;
+}ghtask_s;
+
+typedef struct ghdeque {
+	pthread_mutex_t lock;
+	ghtask_s * tasks;
+	long head;          // oldest task, stolen by other workers
+	long tail;          // newest task, popped by the owner
+	long size;
+}ghdeque_s;
+
+typedef struct ghworker {
+	struct ghpool * pool;
+	int id;
+}ghworker_s;
+
+typedef struct ghpool {
+	int nthreads;
+	pthread_t threads[GHPOOLMAX];
+	ghworker_s workers[GHPOOLMAX];
+	ghdeque_s deques[GHPOOLMAX];
+	pthread_mutex_t lock;
+	pthread_cond_t work;    // signalled when tasks are queued
+	pthread_cond_t idle;    // signalled when the last task finishes
+	long queued;            // tasks sitting in deques
+	long pending;           // tasks queued or running
+	int next;               // deque the next submitted task goes to
+	int stop;
+}ghpool_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+ghpool_s * GhPoolCreate(int nthreads);
+int GhPoolSubmit(ghpool_s * pool, ghtask_f fn, void * arg);
+void GhPoolWait(ghpool_s * pool);
+void GhPoolDestroy(ghpool_s * pool);
+/// @endcond
+#endif
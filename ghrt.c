@@ -0,0 +1,302 @@
+/** Real-time mode functions
+ * The control thread is pinned to one core under SCHED_FIFO with all of
+ * its memory locked and touched up front, so a tick neither waits behind
+ * the shipper or HMI nor takes a page fault. Every tick stage is timed
+ * against its budget, and GhRtBench measures timer wakeup latency the way
+ * cyclictest does.
+ * @version ghrt.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#define _GNU_SOURCE
+#include <malloc.h>
+#include <sched.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "ghrt.h"
+
+static int rtactive;
+static rtstage_s stages[RTSTAGES];
+static struct timespec rtstart[RTSTAGES];
+static long long rtnext;            // expected timer expiry, 0 if unknown
+static long long rtperiod;          // ns between expiries of a periodic timer
+static char rtout[RTOUTSZ];
+static cpu_set_t rtcpus;            // affinity before the control thread was pinned
+static int rtpinned;
+static const char stagenames[RTSTAGES][8] = {"wake","read","log","control","alarm","send","display","tick"};
+static const long long budgets[RTSTAGES] = { RTWAKEBUDGET, RTREADBUDGET, RTLOGBUDGET,
+	RTCONTROLBUDGET, RTALARMBUDGET, RTSENDBUDGET, RTDISPLAYBUDGET, RTTICKBUDGET };
+
+/** Reads the monotonic clock
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static long long GhRtNanos(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** Touches RTSTACK bytes of stack so later calls do not fault it in
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static __attribute__((noinline)) void GhRtStack(void) {
+	volatile char buf[RTSTACK];
+	for (int i = 0; i < RTSTACK; i += 4096) {
+		buf[i] = 0;
+	}
+	(void) buf[0];
+}
+
+/** Counts one run of a stage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhRtRecord(rtstage_s * s, long long ns, long long budgetus) {
+	long long us;
+	int b = 0;
+
+	ns = ns < 0 ? 0 : ns;
+	us = ns / 1000;
+	if (s->count == 0 || ns < s->min) {
+		s->min = ns;
+	}
+	if (ns > s->max) {
+		s->max = ns;
+	}
+	s->count++;
+	s->total += ns;
+	if (us >= budgetus) {
+		s->misses++;
+	}
+	while (b < RTHIST - 1 && us >= (1LL << b)) {
+		b++;
+	}
+	s->hist[b]++;
+}
+
+/** Enters real-time mode: locks and touches memory, buffers stdout, pins
+ * the calling thread to a core and makes it SCHED_FIFO. Threads started
+ * afterwards inherit the core and the policy until they call GhRtRelease.
+ * Stage timing starts even if
+ * a step fails, so the report shows what the system gave.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param cpu core to run on, -1 to leave the affinity alone
+ * @param priority SCHED_FIFO priority, 0 for RTPRIORITY
+ * @return 1 if every step succeeded, 0 otherwise
+ */
+int GhRtEnable(int cpu, int priority) {
+	struct sched_param sp = {0};
+	cpu_set_t set;
+	char * heap;
+	int ok = 1;
+
+	// Freed memory stays with the process instead of going back to the kernel
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+		perror("Error (call to 'mlockall')");
+		ok = 0;
+	}
+	heap = malloc(RTHEAP);
+	if (heap != NULL) {
+		for (int i = 0; i < RTHEAP; i += 4096) {
+			heap[i] = 0;
+		}
+		free(heap);
+	}
+	GhRtStack();
+	fflush(stdout);
+	setvbuf(stdout, rtout, _IOFBF, RTOUTSZ);
+	if (cpu >= 0) {
+		rtpinned = sched_getaffinity(0, sizeof(rtcpus), &rtcpus) == 0;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+			perror("Error (call to 'sched_setaffinity')");
+			ok = 0;
+		}
+	}
+	sp.sched_priority = priority > 0 ? priority : RTPRIORITY;
+	if (sched_setscheduler(0, SCHED_FIFO, &sp) == -1) {
+		perror("Error (call to 'sched_setscheduler')");
+		ok = 0;
+	}
+	memset(stages, 0, sizeof(stages));
+	rtactive = 1;
+	return ok;
+}
+
+/** Takes the calling thread off the real-time core and policy, for worker
+ * threads started after GhRtEnable
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhRtRelease(void) {
+	struct sched_param sp = {0};
+
+	sched_setscheduler(0, SCHED_OTHER, &sp);
+	if (rtpinned) {
+		sched_setaffinity(0, sizeof(rtcpus), &rtcpus);
+	}
+}
+
+/** Tells whether stage timing is on
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 after GhRtEnable
+ */
+int GhRtIsEnabled(void) {
+	return rtactive;
+}
+
+/** Notes when the tick timer will next expire
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param milliseconds time from now to the expiry
+ * @param periodic 1 if the timer repeats every milliseconds
+ */
+void GhRtArm(int milliseconds, int periodic) {
+	if (!rtactive) {
+		return;
+	}
+	rtperiod = periodic ? milliseconds * 1000000LL : 0;
+	rtnext = GhRtNanos() + milliseconds * 1000000LL;
+}
+
+/** Starts a tick: counts the wakeup latency against the expected expiry,
+ * and every expiry a periodic timer skipped as a miss
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param expired 1 if the timer started the tick, 0 if it was called directly
+ */
+void GhRtWake(int expired) {
+	long long now;
+
+	if (!rtactive) {
+		return;
+	}
+	now = GhRtNanos();
+	clock_gettime(CLOCK_MONOTONIC, &rtstart[RTTICK]);
+	if (!expired || rtnext == 0) {
+		return;
+	}
+	GhRtRecord(&stages[RTWAKE], now - rtnext, budgets[RTWAKE]);
+	if (rtperiod == 0) {
+		rtnext = 0;
+		return;
+	}
+	rtnext += rtperiod;
+	while (rtnext <= now) {
+		stages[RTWAKE].misses++;
+		rtnext += rtperiod;
+	}
+}
+
+/** Starts timing a stage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param stage RTREAD to RTDISPLAY
+ */
+void GhRtBegin(int stage) {
+	if (rtactive) {
+		clock_gettime(CLOCK_MONOTONIC, &rtstart[stage]);
+	}
+}
+
+/** Finishes timing a stage and checks it against its budget
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param stage RTREAD to RTTICK
+ */
+void GhRtEnd(int stage) {
+	long long start;
+
+	if (!rtactive) {
+		return;
+	}
+	start = (long long) rtstart[stage].tv_sec * 1000000000LL + rtstart[stage].tv_nsec;
+	GhRtRecord(&stages[stage], GhRtNanos() - start, budgets[stage]);
+}
+
+/** Gets the timing of a stage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param stage RTWAKE to RTTICK
+ * @return counters
+ */
+rtstage_s GhRtStage(int stage) {
+	return stages[stage];
+}
+
+/** Prints the non-empty buckets of a latency histogram
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhRtHistogram(FILE * fp, const rtstage_s * s) {
+	for (int b = 0; b < RTHIST; b++) {
+		if (s->hist[b] > 0) {
+			fprintf(fp, "  < %8lld us %10ld\n", 1LL << b, s->hist[b]);
+		}
+	}
+}
+
+/** Prints every stage against its budget and the wakeup histogram
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ */
+void GhRtReport(FILE * fp) {
+	rtstage_s * s;
+
+	if (!rtactive) {
+		return;
+	}
+	fprintf(fp, "Stage       runs    min us    avg us    max us  budget us  misses\n");
+	for (int i = 0; i < RTSTAGES; i++) {
+		s = &stages[i];
+		fprintf(fp, "%-8s %7ld %9.1lf %9.1lf %9.1lf %10lld %7ld\n", stagenames[i], s->count,
+			s->min / 1000.0, s->count > 0 ? s->total / 1000.0 / s->count : 0.0, s->max / 1000.0,
+			budgets[i], s->misses);
+	}
+	fprintf(fp, "Wakeup latency\n");
+	GhRtHistogram(fp, &stages[RTWAKE]);
+	fflush(fp);
+}
+
+/** Measures timer wakeup latency like cyclictest: sleeps to absolute
+ * deadlines intervalus apart and times how late each wakeup is
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param loops number of wakeups
+ * @param intervalus microseconds between them, 0 for RTBENCHUS
+ * @param fp stream to print the results to
+ */
+void GhRtBench(long loops, int intervalus, FILE * fp) {
+	rtstage_s s = {0};
+	struct timespec next;
+	long long interval;
+
+	interval = (intervalus > 0 ? intervalus : RTBENCHUS) * 1000LL;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (long i = 0; i < loops; i++) {
+		next.tv_nsec += interval;
+		while (next.tv_nsec >= 1000000000L) {
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+		GhRtRecord(&s, GhRtNanos() - ((long long) next.tv_sec * 1000000000LL + next.tv_nsec),
+			RTWAKEBUDGET);
+	}
+	fprintf(fp, "Latency %s: %ld wakeups every %lld us, min %.1lf us, avg %.1lf us, max %.1lf us, "
+		"%ld over %d us\n", rtactive ? "real-time" : "normal", s.count, interval / 1000,
+		s.min / 1000.0, s.count > 0 ? s.total / 1000.0 / s.count : 0.0, s.max / 1000.0,
+		s.misses, RTWAKEBUDGET);
+	GhRtHistogram(fp, &s);
+	fflush(fp);
+}
@@ -0,0 +1,59 @@
+/** Real-time mode constants, structures, function prototypes
+ * @version ghrt.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHRT_H
+#define GHRT_H
+
+#include <stdio.h>
+
+// Constants ##############################################
+#define RTPRIORITY 80           // SCHED_FIFO priority, below the kernel's own threads
+#define RTSTACK (256 * 1024)    // stack touched at startup
+#define RTHEAP (1024 * 1024)    // heap touched at startup and never given back
+#define RTOUTSZ 8192            // stdout buffer, flushed once a tick
+#define RTBENCHUS 1000          // benchmark wakeup interval in microseconds
+#define RTHIST 24               // latency histogram buckets, powers of two microseconds
+// Stages of a tick, each with its budget in microseconds
+#define RTWAKE 0                // timer expiry to the start of the tick
+#define RTREAD 1
+#define RTLOG 2
+#define RTCONTROL 3
+#define RTALARM 4
+#define RTSEND 5                // collector and notification posts, checkpoint
+#define RTDISPLAY 6
+#define RTTICK 7                // the whole tick
+#define RTSTAGES 8
+#define RTWAKEBUDGET 1000
+#define RTREADBUDGET 50000
+#define RTLOGBUDGET 2000
+#define RTCONTROLBUDGET 500
+#define RTALARMBUDGET 500
+#define RTSENDBUDGET 1000
+#define RTDISPLAYBUDGET 20000
+#define RTTICKBUDGET 80000
+
+// Structures ##########################################
+typedef struct rtstage {
+	long count;
+	long misses;            // runs over budget
+	long long min;          // nanoseconds
+	long long max;
+	long long total;
+	long hist[RTHIST];      // bucket i counts runs under 2^i microseconds
+}rtstage_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhRtEnable(int cpu, int priority);
+void GhRtRelease(void);
+int GhRtIsEnabled(void);
+void GhRtArm(int milliseconds, int periodic);
+void GhRtWake(int expired);
+void GhRtBegin(int stage);
+void GhRtEnd(int stage);
+rtstage_s GhRtStage(int stage);
+void GhRtReport(FILE * fp);
+void GhRtBench(long loops, int intervalus, FILE * fp);
+/// @endcond
+#endif
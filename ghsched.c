@@ -0,0 +1,179 @@
+/** Adaptive sampling scheduler functions
+ * Every sensor keeps its own interval. A steady reading far from the
+ * setpoints and alarm limits stretches it towards the longest interval,
+ * a moving one shrinks it at once. The interval never exceeds half the
+ * time the current rate of change needs to reach the nearest threshold.
+ * @version ghsched.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <math.h>
+#include "ghsched.h"
+
+static schedsensor_s sensors[SENSORS];
+static int smin = SCHEDMIN;
+static int smax = SCHEDMAX;
+static const char schednames[SENSORS][12] = {"temperature","humidity","pressure"};
+
+/** Starts every sensor at the shortest interval, due now
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param minms shortest interval in ms, 0 for SCHEDMIN
+ * @param maxms longest interval in ms, 0 for SCHEDMAX
+ * @param now current GhClockMillis
+ */
+void GhSchedInit(int minms, int maxms, long long now) {
+	smin = minms > 0 ? minms : SCHEDMIN;
+	smax = maxms > smin ? maxms : (SCHEDMAX > smin ? SCHEDMAX : smin);
+	for (int i = 0; i < SENSORS; i++) {
+		sensors[i].interval = smin;
+		sensors[i].due = now;
+		sensors[i].lastms = 0;
+		sensors[i].samples = 0;
+	}
+}
+
+/** Makes every sensor due by a time at the shortest interval, after the
+ * setpoints changed; a sensor already due sooner keeps its time
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now time by which every sensor is due, in GhClockMillis
+ */
+void GhSchedWake(long long now) {
+	for (int i = 0; i < SENSORS; i++) {
+		sensors[i].interval = smin;
+		sensors[i].due = sensors[i].due < now ? sensors[i].due : now;
+	}
+}
+
+/** Gets the sensors due for a sample
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now current GhClockMillis
+ * @return bit i set when sensor i is due
+ */
+unsigned int GhSchedDue(long long now) {
+	unsigned int mask = 0;
+	for (int i = 0; i < SENSORS; i++) {
+		if (sensors[i].due <= now) {
+			mask |= 1u << i;
+		}
+	}
+	return mask;
+}
+
+/** Distance from a value to the nearest of its thresholds
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static double GhSchedDistance(double v, const double * thr, int n) {
+	double d = HUGE_VAL;
+	for (int i = 0; i < n; i++) {
+		d = fmin(d, fabs(v - thr[i]));
+	}
+	return d;
+}
+
+/** Sets the next interval of the sensors just sampled
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param sampled mask of the sensors read into rdata
+ * @param rdata readings
+ * @param spts setpoints the controls act on
+ * @param alimits alarm limits
+ * @param tband heater deadband
+ * @param hband humidifier deadband
+ * @param now current GhClockMillis
+ */
+void GhSchedUpdate(unsigned int sampled, reading_s rdata, setpoint_s spts, alarmlimit_s alimits,
+		double tband, double hband, long long now) {
+	const double value[SENSORS] = { rdata.temperature, rdata.humidity, rdata.pressure };
+	const double steady[SENSORS] = { SCHEDTSTEADY, SCHEDHSTEADY, SCHEDPSTEADY };
+	const double noise[SENSORS] = { SCHEDTNOISE, SCHEDHNOISE, SCHEDPNOISE };
+	const double margin[SENSORS] = { SCHEDTMARGIN, SCHEDHMARGIN, SCHEDPMARGIN };
+	const double thr[SENSORS][4] = {
+		{ spts.temperature, spts.temperature - tband, alimits.hight, alimits.lowt },
+		{ spts.humidity, spts.humidity - hband, alimits.highh, alimits.lowh },
+		{ alimits.highp, alimits.lowp }};
+	const int nthr[SENSORS] = { 4, 4, 2 };
+	schedsensor_s * s;
+	double rate, dist, limit, change;
+
+	for (int i = 0; i < SENSORS; i++) {
+		if (!(sampled & (1u << i))) {
+			continue;
+		}
+		s = &sensors[i];
+		s->samples++;
+		// Only change beyond the noise counts, or short intervals never stretch
+		rate = 0.0;
+		if (s->lastms != 0 && now > s->lastms) {
+			change = fabs(value[i] - s->last) - noise[i];
+			rate = change > 0.0 ? change * 60000.0 / (double)(now - s->lastms) : 0.0;
+		}
+		dist = GhSchedDistance(value[i], thr[i], nthr[i]);
+		if (rdata.quality[i] != QGOOD || dist <= margin[i]) {
+			s->interval = smin;
+		}
+		else if (rate > steady[i]) {
+			s->interval /= SCHEDSHRINK;
+		}
+		else {
+			s->interval = (int) fmax(s->interval * SCHEDGROW, s->interval + smin);
+		}
+		// Sample at least twice before the rate can carry it to a threshold
+		if (rate > 0.0) {
+			limit = dist / rate * 60000.0 / 2.0;
+			if (limit < s->interval) {
+				s->interval = (int) limit;
+			}
+		}
+		s->interval = s->interval < smin ? smin : (s->interval > smax ? smax : s->interval);
+		// Whole multiples of the shortest interval keep the sensors in step,
+		// so one wakeup serves every sensor due
+		s->interval -= s->interval % smin;
+		s->last = value[i];
+		s->lastms = now;
+		s->due = now + s->interval;
+	}
+}
+
+/** Gets the time the next sensor is due
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return GhClockMillis of the earliest due sample
+ */
+long long GhSchedNext(void) {
+	long long next = sensors[0].due;
+	for (int i = 1; i < SENSORS; i++) {
+		if (sensors[i].due < next) {
+			next = sensors[i].due;
+		}
+	}
+	return next;
+}
+
+/** Gets the number of samples taken of a sensor
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param sensor TEMPERATURE, HUMIDITY or PRESSURE
+ * @return samples since GhSchedInit
+ */
+long GhSchedSamples(int sensor) {
+	return sensors[sensor].samples;
+}
+
+/** Prints samples per sensor against a fixed GHUPDATE interval
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ * @param elapsed ms covered by the run
+ */
+void GhSchedReport(FILE * fp, long long elapsed) {
+	long fixed = (long)(elapsed / GHUPDATE) + 1;
+
+	for (int i = 0; i < SENSORS; i++) {
+		fprintf(fp, "Schedule %-11s %8ld samples (fixed %ld: %.1lf%%), interval now %d ms\n",
+			schednames[i], sensors[i].samples, fixed,
+			100.0 * sensors[i].samples / fixed, sensors[i].interval);
+	}
+}
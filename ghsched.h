@@ -0,0 +1,47 @@
+/** Adaptive sampling scheduler constants, structures, function prototypes
+ * @version ghsched.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHSCHED_H
+#define GHSCHED_H
+
+#include <stdio.h>
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define SCHEDMIN GHUPDATE       // ms shortest interval of a sensor
+#define SCHEDMAX 60000          // ms longest interval of a sensor
+#define SCHEDGROW 1.5           // interval stretch after a steady sample
+#define SCHEDSHRINK 4           // interval divisor after a moving sample
+#define SCHEDTSTEADY 0.2        // C per minute still counted as steady
+#define SCHEDHSTEADY 1.0        // % per minute
+#define SCHEDPSTEADY 0.5        // hPa per minute
+#define SCHEDTNOISE 0.2         // C change between samples put down to sensor noise
+#define SCHEDHNOISE 0.5         // %
+#define SCHEDPNOISE 0.3         // hPa
+#define SCHEDTMARGIN 0.5        // C from a setpoint or limit sampled at SCHEDMIN
+#define SCHEDHMARGIN 2.0        // %
+#define SCHEDPMARGIN 1.0        // hPa
+#define SCHEDALL ((1u << SENSORS) - 1)
+
+// Structures ##########################################
+typedef struct schedsensor {
+	int interval;           // ms
+	long long due;          // ms of the clock the next sample is due
+	double last;            // value of the last sample
+	long long lastms;
+	long samples;
+}schedsensor_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+void GhSchedInit(int minms, int maxms, long long now);
+void GhSchedWake(long long now);
+unsigned int GhSchedDue(long long now);
+void GhSchedUpdate(unsigned int sampled, reading_s rdata, setpoint_s spts, alarmlimit_s alimits,
+	double tband, double hband, long long now);
+long long GhSchedNext(void);
+long GhSchedSamples(int sensor);
+void GhSchedReport(FILE * fp, long long elapsed);
+/// @endcond
+#endif
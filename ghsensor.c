@@ -0,0 +1,164 @@
+/** Sensor registry functions
+ * Probes beyond the three Sense HAT channels register here with the driver
+ * that serves them. Drivers measure on their own threads and publish each
+ * result with GhSensorUpdate, so the control loop only ever copies values.
+ * @version ghsensor.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include "ghsensor.h"
+
+static sensor_s sensors[SENSORMAX];
+static int nsensors;
+static const sensordrv_s * drivers[SENSORDRIVERS];
+static int ndrivers;
+static pthread_mutex_t slock = PTHREAD_MUTEX_INITIALIZER;
+static time_t sstart;                   // time of the latest cycle
+static time_t sgap;                     // seconds between the latest two cycles
+static const char qualitytags[3][6] = {"","stale","bad"};
+
+/** Adds a probe to the registry
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param id unique name of the probe, such as its bus address
+ * @param kind what it measures, such as temperature
+ * @param drv driver serving it
+ * @return index of the probe, -1 if the registry or driver table is full
+ */
+int GhSensorRegister(const char * id, const char * kind, const sensordrv_s * drv) {
+	int d, idx;
+
+	pthread_mutex_lock(&slock);
+	for (d = 0; d < ndrivers && drivers[d] != drv; d++) {
+	}
+	if (nsensors == SENSORMAX || (d == ndrivers && ndrivers == SENSORDRIVERS)) {
+		pthread_mutex_unlock(&slock);
+		return -1;
+	}
+	if (d == ndrivers) {
+		drivers[ndrivers++] = drv;
+	}
+	idx = nsensors++;
+	memset(&sensors[idx], 0, sizeof(sensor_s));
+	snprintf(sensors[idx].id, SENSORIDSZ, "%s", id);
+	snprintf(sensors[idx].kind, SENSORKINDSZ, "%s", kind);
+	sensors[idx].drv = drv;
+	sensors[idx].quality = QBAD;
+	pthread_mutex_unlock(&slock);
+	return idx;
+}
+
+/** Publishes a result, from any thread
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param idx index from GhSensorRegister
+ * @param value measured value, ignored unless quality is QGOOD
+ * @param quality QGOOD, or QBAD if the measurement failed
+ * @param rtime time of the measurement
+ */
+void GhSensorUpdate(int idx, double value, quality_e quality, time_t rtime) {
+	sensor_s * s;
+
+	if (idx < 0 || idx >= nsensors) {
+		return;
+	}
+	pthread_mutex_lock(&slock);
+	s = &sensors[idx];
+	s->reads++;
+	if (quality == QGOOD) {
+		s->value = value;
+		s->rtime = rtime;
+	}
+	else {
+		s->errors++;
+	}
+	s->quality = quality;
+	pthread_mutex_unlock(&slock);
+}
+
+/** Gets the number of registered probes
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return probes
+ */
+int GhSensorCount(void) {
+	return nsensors;
+}
+
+/** Gets the latest result of a probe, marked stale when it is older than
+ * the interval between the last two cycles plus SENSORSTALE seconds, so
+ * a result stands until the cycle after it is due; a failed probe keeps
+ * its last good value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param idx index from GhSensorRegister
+ * @param now current time
+ * @return copy of the probe
+ */
+sensor_s GhSensorGet(int idx, time_t now) {
+	sensor_s s;
+
+	pthread_mutex_lock(&slock);
+	s = sensors[idx];
+	pthread_mutex_unlock(&slock);
+	if (s.quality == QGOOD && (s.rtime == 0 || now - s.rtime > sgap + SENSORSTALE)) {
+		s.quality = QSTALE;
+	}
+	return s;
+}
+
+/** Starts a measurement cycle in every driver
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now time of the tick, which stamps the results of the cycle
+ */
+void GhSensorStart(time_t now) {
+	sgap = sstart != 0 && now > sstart ? now - sstart : 0;
+	sstart = now;
+	for (int d = 0; d < ndrivers; d++) {
+		drivers[d]->start(now);
+	}
+}
+
+/** Stops every driver
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhSensorClose(void) {
+	for (int d = 0; d < ndrivers; d++) {
+		drivers[d]->close();
+	}
+	ndrivers = 0;
+}
+
+/** Displays every probe
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now current time
+ */
+void GhSensorDisplay(time_t now) {
+	sensor_s s;
+
+	for (int i = 0; i < nsensors; i++) {
+		s = GhSensorGet(i, now);
+		fprintf(stdout, "%-18s %-11s %6.2lf %s\n", s.id, s.kind, s.value, qualitytags[s.quality]);
+	}
+}
+
+/** Prints results and errors per probe
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fp stream to print to
+ */
+void GhSensorReport(FILE * fp) {
+	long reads = 0, errors = 0;
+
+	for (int i = 0; i < nsensors; i++) {
+		pthread_mutex_lock(&slock);
+		reads += sensors[i].reads;
+		errors += sensors[i].errors;
+		pthread_mutex_unlock(&slock);
+	}
+	if (nsensors > 0) {
+		fprintf(fp, "Probes: %d registered, %ld results, %ld errors\n", nsensors, reads, errors);
+	}
+}
@@ -0,0 +1,47 @@
+/** Sensor registry constants, structures, function prototypes
+ * @version ghsensor.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHSENSOR_H
+#define GHSENSOR_H
+
+#include <pthread.h>
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define SENSORMAX 64            // probes beyond the Sense HAT channels
+#define SENSORDRIVERS 4
+#define SENSORIDSZ 32
+#define SENSORKINDSZ 12
+#define SENSORSTALE 10          // seconds a result may lag the last cycle interval before it is stale
+
+// Structures ##########################################
+typedef struct sensordrv {
+	const char * name;
+	void (*start)(time_t now); // begins a cycle on every probe of the driver, never blocks
+	void (*close)(void);
+}sensordrv_s;
+
+typedef struct sensor {
+	char id[SENSORIDSZ];
+	char kind[SENSORKINDSZ];
+	const sensordrv_s * drv;
+	double value;
+	quality_e quality;
+	time_t rtime;           // time of the last result, 0 before the first
+	long reads;
+	long errors;
+}sensor_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhSensorRegister(const char * id, const char * kind, const sensordrv_s * drv);
+void GhSensorUpdate(int idx, double value, quality_e quality, time_t rtime);
+int GhSensorCount(void);
+sensor_s GhSensorGet(int idx, time_t now);
+void GhSensorStart(time_t now);
+void GhSensorClose(void);
+void GhSensorDisplay(time_t now);
+void GhSensorReport(FILE * fp);
+/// @endcond
+#endif
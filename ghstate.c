@@ -0,0 +1,177 @@
+/** Controller checkpoint functions
+ * The state a restart would otherwise relearn over several ticks (active
+ * alarms, last control outputs, last readings and the quality filter
+ * history), plus the setpoints and limits in force, is written every tick
+ * into one of two page sized slots of a memory mapped file. The slots are
+ * written alternately and each carries a sequence number and a CRC, so a
+ * crash in the middle of a write leaves the other slot to resume from.
+ * @version ghstate.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <stddef.h>
+#include "ghstate.h"
+#include "ghcrc.h"
+
+static unsigned char * smap;
+static int sfd = -1;
+static statestats_s sstats;
+
+_Static_assert(sizeof(stateslot_s) <= STATESLOTSZ, "stateslot_s must fit a slot");
+
+/** CRC of a slot, from seq to the end
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static uint32_t GhStateCrc(const stateslot_s * slot) {
+	return GhCrc32(0, (const unsigned char *) slot + offsetof(stateslot_s, seq),
+		sizeof(stateslot_s) - offsetof(stateslot_s, seq));
+}
+
+/** Opens or creates the state file and maps it
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the file
+ * @return 1 if successful, 0 on error
+ */
+int GhStateOpen(const char * fname) {
+	struct stat st;
+
+	sfd = open(fname, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (sfd == -1) {
+		return 0;
+	}
+	if (fstat(sfd, &st) == -1
+			|| (st.st_size < STATESLOTS * STATESLOTSZ && ftruncate(sfd, STATESLOTS * STATESLOTSZ) == -1)) {
+		close(sfd);
+		sfd = -1;
+		return 0;
+	}
+	smap = mmap(NULL, STATESLOTS * STATESLOTSZ, PROT_READ | PROT_WRITE, MAP_SHARED, sfd, 0);
+	if (smap == MAP_FAILED) {
+		smap = NULL;
+		close(sfd);
+		sfd = -1;
+		return 0;
+	}
+	return 1;
+}
+
+/** Resumes from the newest whole slot: the active alarms are raised again
+ * with their original times, and the controls, readings and filter
+ * history are those of the last tick. The setpoints and limits are
+ * handed back for the caller to use if it has nothing newer.
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param state receives the checkpoint; its arecord must be an empty list
+ * @param now current time
+ * @return 1 if resumed, 0 if there is no whole slot of this version or it is
+ * older than STATEMAXAGE
+ */
+int GhStateLoad(ghstate_s * state, time_t now) {
+	const stateslot_s * slot, * best = NULL;
+
+	if (smap == NULL) {
+		return 0;
+	}
+	for (int i = 0; i < STATESLOTS; i++) {
+		slot = (const stateslot_s *)(smap + i * STATESLOTSZ);
+		if (slot->magic != STATEMAGIC || slot->version != STATEVERSION
+				|| slot->size != sizeof(stateslot_s) || slot->crc != GhStateCrc(slot)) {
+			continue;
+		}
+		if (best == NULL || slot->seq > best->seq) {
+			best = slot;
+		}
+	}
+	// Number on from the newest slot even when not resuming, or a stale
+	// slot would outrank the fresh ones written after it
+	sstats.seq = best != NULL ? best->seq : 0;
+	if (best == NULL || now - best->saved > STATEMAXAGE || best->saved > now + STATEMAXAGE) {
+		return 0;
+	}
+	state->spts = best->spts;
+	state->alimits = best->alimits;
+	state->ctrl = best->ctrl;
+	state->creadings = best->creadings;
+	GhSetFilter(best->filter);
+	for (uint32_t i = 0; i < best->nalarms && i < NALARMS; i++) {
+		GhSetOneAlarm((alarm_e) best->alarms[i].code, (time_t) best->alarms[i].atime,
+			best->alarms[i].value, state->arecord);
+	}
+	sstats.restored = 1;
+	sstats.seq = best->seq;
+	sstats.age = (long)(now - best->saved);
+	sstats.saves = 0;
+	return 1;
+}
+
+/** Writes the state into the older slot
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param state controller state after a tick
+ * @param now time of the tick
+ */
+void GhStateSave(const ghstate_s * state, time_t now) {
+	stateslot_s * slot;
+	alarm_s * cur;
+	uint64_t seq = sstats.seq + 1;
+
+	if (smap == NULL) {
+		return;
+	}
+	slot = (stateslot_s *)(smap + (seq % STATESLOTS) * STATESLOTSZ);
+	// Spoil the slot first, so a crash before the CRC leaves it rejected
+	slot->magic = 0;
+	slot->seq = seq;
+	slot->saved = (int64_t) now;
+	slot->spts = state->spts;
+	slot->alimits = state->alimits;
+	slot->ctrl = state->ctrl;
+	slot->creadings = state->creadings;
+	slot->filter = GhGetFilter();
+	slot->nalarms = 0;
+	slot->pad = 0;
+	memset(slot->alarms, 0, sizeof(slot->alarms));
+	for (cur = state->arecord; cur != NULL && slot->nalarms < NALARMS; cur = cur->next) {
+		if (cur->code != NOALARM) {
+			slot->alarms[slot->nalarms].code = cur->code;
+			slot->alarms[slot->nalarms].atime = (int64_t) cur->atime;
+			slot->alarms[slot->nalarms].value = cur->value;
+			slot->nalarms++;
+		}
+	}
+	slot->version = STATEVERSION;
+	slot->size = sizeof(stateslot_s);
+	slot->crc = GhStateCrc(slot);
+	slot->magic = STATEMAGIC;
+	// Start writeback without waiting for it; the page cache already
+	// survives a crash of the process
+	msync(slot, STATESLOTSZ, MS_ASYNC);
+	sstats.seq = seq;
+	sstats.saves++;
+}
+
+/** Unmaps and closes the state file
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+void GhStateClose(void) {
+	if (smap != NULL) {
+		msync(smap, STATESLOTS * STATESLOTSZ, MS_SYNC);
+		munmap(smap, STATESLOTS * STATESLOTSZ);
+		smap = NULL;
+	}
+	if (sfd != -1) {
+		close(sfd);
+		sfd = -1;
+	}
+}
+
+/** Gets the checkpoint counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return counters
+ */
+statestats_s GhStateStats(void) {
+	return sstats;
+}
@@ -0,0 +1,59 @@
+/** Controller checkpoint constants, structures, function prototypes
+ * @version ghstate.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHSTATE_H
+#define GHSTATE_H
+
+#include <stdint.h>
+#include "ghcontrol.h"
+
+// Constants ##############################################
+#define STATEFILE "ghstate.dat"
+#define STATEMAGIC 0x54534847   // "GHST"
+#define STATEVERSION 2          // raise with every change to stateslot_s
+#define STATESLOTS 2            // written alternately, so one is always whole
+#define STATESLOTSZ 4096        // one page per slot
+#define STATEMAXAGE 600         // seconds after which a checkpoint is too old to resume from
+
+// Structures ##########################################
+typedef struct statealarm {
+	int32_t code;
+	int32_t pad;
+	int64_t atime;
+	double value;
+}statealarm_s;
+
+typedef struct stateslot {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;          // sizeof(stateslot_s), catches a layout change without a version
+	uint32_t crc;           // of everything after it
+	uint64_t seq;           // the newer slot has the higher one
+	int64_t saved;          // time of the tick it records
+	setpoint_s spts;
+	alarmlimit_s alimits;
+	control_s ctrl;
+	reading_s creadings;
+	filter_s filter;
+	uint32_t nalarms;
+	uint32_t pad;
+	statealarm_s alarms[NALARMS];
+}stateslot_s;
+
+typedef struct statestats {
+	long saves;
+	int restored;           // 1 if GhStateLoad resumed from the file
+	uint64_t seq;
+	long age;               // seconds between the restored tick and the restart
+}statestats_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhStateOpen(const char * fname);
+int GhStateLoad(ghstate_s * state, time_t now);
+void GhStateSave(const ghstate_s * state, time_t now);
+void GhStateClose(void);
+statestats_s GhStateStats(void);
+/// @endcond
+#endif
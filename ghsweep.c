@@ -0,0 +1,301 @@
+/** Replays recorded ghdata.txt histories through the control and alarm
+ * logic for a grid of setpoints, deadbands and alarm limits, one task per
+ * configuration on a work stealing thread pool.
+ * @version ghsweep.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include "ghcontrol.h"
+#include "ghpool.h"
+#include "ghcompress.h"
+#include "ghcolumn.h"
+
+// Constants ##############################################
+#define SWEEPPARAMS 7
+#define SWEEPGAP 60         // longest gap in seconds an output is credited between rows
+#define SWEEPLINESZ 256
+
+// Structures ##########################################
+typedef struct range {
+	double lo;
+	double hi;
+	double step;
+	int n;
+}range_s;
+
+typedef struct sweepcfg {
+	setpoint_s spts;
+	double tband;
+	double hband;
+	alarmlimit_s limits;
+	double heateron;    // seconds
+	double humidon;
+	long heatsw;
+	long humidsw;
+	long alarms[NALARMS];
+}sweepcfg_s;
+
+static reading_s * rows;
+static long nrows;
+
+/** Parses lo:hi:step or a single value
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful, 0 if the range is malformed
+ */
+static int GhSweepRange(const char * arg, range_s * r) {
+	int n = sscanf(arg, "%lf:%lf:%lf", &r->lo, &r->hi, &r->step);
+	if (n == 1) {
+		r->hi = r->lo;
+		r->step = 1.0;
+	}
+	else if (n != 3 || r->step <= 0 || r->hi < r->lo) {
+		return 0;
+	}
+	r->n = (int)((r->hi - r->lo) / r->step + 1e-9) + 1;
+	return 1;
+}
+
+/** Makes room for one more row
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return 1 if successful, 0 if out of memory
+ */
+static int GhSweepGrow(void) {
+	static long cap = 0;
+	reading_s * grown;
+
+	if (nrows < cap) {
+		return 1;
+	}
+	cap = cap ? cap * 2 : 4096;
+	grown = realloc(rows, cap * sizeof(reading_s));
+	if (grown == NULL) {
+		return 0;
+	}
+	rows = grown;
+	return 1;
+}
+
+/** Loads a compressed log rebuilt at every GHUPDATE
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param series archived points of each sensor
+ * @return 1 if successful, 0 if out of memory
+ */
+static int GhSweepExpand(compseries_s series[SENSORS]) {
+	time_t first, last;
+
+	GhCompressSpan(series, &first, &last);
+	for (time_t t = first; first != 0 && t <= last; t += GHUPDATE / 1000) {
+		if (!GhSweepGrow()) {
+			return 0;
+		}
+		rows[nrows++] = GhCompressReading(series, t);
+	}
+	return 1;
+}
+
+/** Loads every parsable row of a GhLogData file, a columnar file written
+ * by ghimport, or a compressed log
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param fname Name of the file
+ * @param bad incremented for every malformed row
+ * @return 1 if successful, 0 if the file could not be read
+ */
+static int GhSweepLoad(const char * fname, long * bad) {
+	compseries_s series[SENSORS];
+	char line[SWEEPLINESZ];
+	reading_s * crows;
+	long n;
+	FILE * fp;
+	int ok;
+
+	n = GhColumnRead(fname, &crows);
+	if (n == -2) {
+		fprintf(stderr, "%s is damaged\n", fname);
+		return 0;
+	}
+	for (long i = 0; i < n; i++) {
+		if (!GhSweepGrow()) {
+			free(crows);
+			return 0;
+		}
+		rows[nrows++] = crows[i];
+	}
+	if (n >= 0) {
+		free(crows);
+		return 1;
+	}
+	if (GhCompressLoad(fname, series)) {
+		ok = GhSweepExpand(series);
+		GhCompressFree(series);
+		return ok;
+	}
+	fp = fopen(fname, "r");
+	if (fp == NULL) {
+		fprintf(stderr, "Can't open %s\n", fname);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (!GhSweepGrow()) {
+			fclose(fp);
+			return 0;
+		}
+		if (GhParseLogRow(line, &rows[nrows])) {
+			nrows++;
+		}
+		else {
+			(*bad)++;
+		}
+	}
+	fclose(fp);
+	return 1;
+}
+
+/** Replays the history for one configuration
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param arg sweepcfg_s to run, results are stored in it
+ */
+static void GhSweepRun(void * arg) {
+	sweepcfg_s * c = arg;
+	control_s ctrl = {0}, prev = {0};
+	alarm_s * head, * next;
+	unsigned int mask = 0, nmask;
+	double dt;
+
+	head = GhAlarmNew();
+	if (head == NULL) {
+		return;
+	}
+	for (long i = 0; i < nrows; i++) {
+		ctrl = GhSetControlsBand(c->spts, rows[i], prev, c->tband, c->hband);
+		if (i > 0) {
+			c->heatsw += ctrl.heater != prev.heater;
+			c->humidsw += ctrl.humidifier != prev.humidifier;
+		}
+		if (i + 1 < nrows) {
+			dt = (double)(rows[i + 1].rtime - rows[i].rtime);
+			dt = dt < 0 ? 0 : (dt > SWEEPGAP ? SWEEPGAP : dt);
+			c->heateron += ctrl.heater * dt;
+			c->humidon += ctrl.humidifier * dt;
+		}
+		prev = ctrl;
+
+		head = GhSetAlarms(head, c->limits, rows[i]);
+		nmask = GhAlarmMask(head);
+		for (int code = 1; code < NALARMS; code++) {
+			if ((nmask & ~mask) & (1u << code)) {
+				c->alarms[code]++;
+			}
+		}
+		mask = nmask;
+	}
+	while (head != NULL) {
+		next = head->next;
+		GhAlarmDelete(head);
+		head = next;
+	}
+}
+
+/** Prints command line usage
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhSweepUsage(const char * pname) {
+	fprintf(stderr, "Usage: %s [-j threads] [-T r] [-H r] [-D r] [-E r] [-A r] [-U r] [-P r] ghdata.txt...\n"
+		"  r is lo:hi:step or a single value\n"
+		"  -T temperature setpoint   -H humidity setpoint\n"
+		"  -D heater deadband        -E humidifier deadband\n"
+		"  -A high temperature alarm -U high humidity alarm  -P high pressure alarm\n", pname);
+}
+
+int main(int argc, char * argv[]) {
+	const char * flags = "THDEAUP";
+	double defaults[SWEEPPARAMS] = { STEMP, SHUMID, TBAND, HBAND, UPPERATEMP, UPPERAHUMID, UPPERAPRESS };
+	range_s r[SWEEPPARAMS];
+	sweepcfg_s * cfgs, * c;
+	ghpool_s * pool;
+	long ncfgs = 1, bad = 0, k;
+	long long start, ms;
+	int opt, threads = 0, nthreads, idx[SWEEPPARAMS];
+	char * fp;
+
+	for (int p = 0; p < SWEEPPARAMS; p++) {
+		r[p].lo = r[p].hi = defaults[p];
+		r[p].step = 1.0;
+		r[p].n = 1;
+	}
+	while ((opt = getopt(argc, argv, "j:T:H:D:E:A:U:P:h")) != -1) {
+		fp = strchr(flags, opt);
+		if (opt == 'j') {
+			threads = atoi(optarg);
+		}
+		else if (fp == NULL || !GhSweepRange(optarg, &r[fp - flags])) {
+			GhSweepUsage(argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc) {
+		GhSweepUsage(argv[0]);
+		return 1;
+	}
+	for (int i = optind; i < argc; i++) {
+		if (!GhSweepLoad(argv[i], &bad)) {
+			return 1;
+		}
+	}
+	for (int p = 0; p < SWEEPPARAMS; p++) {
+		ncfgs *= r[p].n;
+	}
+	cfgs = calloc(ncfgs, sizeof(sweepcfg_s));
+	pool = GhPoolCreate(threads);
+	if (cfgs == NULL || pool == NULL) {
+		fprintf(stderr, "Cannot allocate memory\n");
+		return 1;
+	}
+
+	// Build the grid, the last parameter varies fastest
+	for (long i = 0; i < ncfgs; i++) {
+		k = i;
+		for (int p = SWEEPPARAMS - 1; p >= 0; p--) {
+			idx[p] = k % r[p].n;
+			k /= r[p].n;
+		}
+		c = &cfgs[i];
+		c->limits = GhSetAlarmLimits();
+		c->spts.temperature = r[0].lo + idx[0] * r[0].step;
+		c->spts.humidity = r[1].lo + idx[1] * r[1].step;
+		c->tband = r[2].lo + idx[2] * r[2].step;
+		c->hband = r[3].lo + idx[3] * r[3].step;
+		c->limits.hight = r[4].lo + idx[4] * r[4].step;
+		c->limits.highh = r[5].lo + idx[5] * r[5].step;
+		c->limits.highp = r[6].lo + idx[6] * r[6].step;
+	}
+
+	start = GhRealClock.millis();
+	for (long i = 0; i < ncfgs; i++) {
+		GhPoolSubmit(pool, GhSweepRun, &cfgs[i]);
+	}
+	GhPoolWait(pool);
+	ms = GhRealClock.millis() - start;
+	nthreads = pool->nthreads;
+	GhPoolDestroy(pool);
+
+	fprintf(stdout, "stemp,shumid,tband,hband,hight,highh,highp,heater_h,humidifier_h,heater_sw,humidifier_sw,htemp,hhumid,hpress,sfault\n");
+	for (long i = 0; i < ncfgs; i++) {
+		c = &cfgs[i];
+		fprintf(stdout, "%.2lf,%.2lf,%.2lf,%.2lf,%.2lf,%.2lf,%.2lf,%.2lf,%.2lf,%ld,%ld,%ld,%ld,%ld,%ld\n",
+			c->spts.temperature, c->spts.humidity, c->tband, c->hband,
+			c->limits.hight, c->limits.highh, c->limits.highp,
+			c->heateron / 3600.0, c->humidon / 3600.0, c->heatsw, c->humidsw,
+			c->alarms[HTEMP], c->alarms[HHUMID], c->alarms[HPRESS], c->alarms[SFAULT]);
+	}
+	fprintf(stderr, "%ld rows (%ld malformed) x %ld configurations in %lld ms on %d threads (%.1lf M rows/s)\n",
+		nrows, bad, ncfgs, ms, nthreads,
+		(double) nrows * ncfgs / 1000.0 / (ms > 0 ? ms : 1));
+	free(cfgs);
+	free(rows);
+	return 0;
+}
@@ -0,0 +1,259 @@
+/** 1-Wire DS18B20 driver functions
+ * Probes are found as 28-* directories under the w1 sysfs root. A cycle
+ * writes "trigger" to the therm_bulk_read file of every bus master, so all
+ * probes on a bus convert at once, waits W1CONVERT ms and then reads each
+ * w1_slave, which returns the converted value without a new conversion.
+ * Cycles run on the driver's own thread; the control loop only signals it,
+ * handing over the time of its tick to stamp the results with, as the
+ * controller clock belongs to the control loop.
+ * Without therm_bulk_read (kernels before 5.10) every w1_slave read
+ * converts on its own and the cycle grows with the number of probes, but
+ * still off the control loop.
+ * @version ghw1.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include "ghw1.h"
+#include "ghrt.h"
+
+static char w1root[W1PATHSZ] = W1ROOT;
+static char probes[SENSORMAX][W1PATHSZ];
+static int probeidx[SENSORMAX];
+static int nprobes;
+static char masters[W1MASTERS][W1PATHSZ];
+static int nmasters;
+static pthread_t w1thread;
+static pthread_mutex_t w1lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t w1cond = PTHREAD_COND_INITIALIZER;
+static int w1running, w1go, w1busy, w1stop;
+static time_t w1time;               // tick that asked for the cycle
+static w1stats_s w1stats;
+
+static void GhW1Start(time_t now);
+static void GhW1Close(void);
+static const sensordrv_s GhW1Driver = { "w1", GhW1Start, GhW1Close };
+
+/** Reads one DS18B20
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param path w1_slave file of the probe
+ * @param quality set to QGOOD or QBAD
+ * @return temperature in degrees Celsius
+ */
+static double GhW1ReadProbe(const char * path, quality_e * quality) {
+	char buf[160];
+	char * t;
+	ssize_t len;
+	long milli;
+	unsigned int pad[W1PADSZ];
+	int fd;
+
+	*quality = QBAD;
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		return 0.0;
+	}
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0) {
+		return 0.0;
+	}
+	buf[len] = '\0';
+	// "xx xx ... : crc=xx YES" then "xx xx ... t=23125"
+	t = strstr(buf, "t=");
+	if (strstr(buf, "YES") == NULL || t == NULL) {
+		return 0.0;
+	}
+	milli = atol(t + 2);
+	if (milli < W1MIN || milli > W1MAX) {
+		return 0.0;
+	}
+	// 85 C is also the power on value; only the untouched scratchpad,
+	// which a conversion always rewrites, tells them apart
+	if (milli == W1POWERON && sscanf(buf, "%x %x %x %x %x %x %x", &pad[0], &pad[1],
+			&pad[2], &pad[3], &pad[4], &pad[5], &pad[6]) == W1PADSZ && pad[6] == W1RESETPAD) {
+		return 0.0;
+	}
+	*quality = QGOOD;
+	return milli / 1000.0;
+}
+
+/** Starts a conversion on every probe of every bus master at once
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return number of bus masters triggered
+ */
+static int GhW1Trigger(void) {
+	int fd, n = 0;
+
+	for (int m = 0; m < nmasters; m++) {
+		fd = open(masters[m], O_WRONLY | O_CLOEXEC);
+		if (fd == -1) {
+			continue;
+		}
+		if (write(fd, "trigger\n", 8) == 8) {
+			n++;
+		}
+		close(fd);
+	}
+	return n;
+}
+
+/** Runs one cycle each time GhW1Start asks for it
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void * GhW1Worker(void * arg) {
+	struct timespec ts;
+	long long start, ms;
+	quality_e quality;
+	double value;
+	sigset_t all;
+	time_t rtime;
+	int bulk;
+
+	sigfillset(&all);
+	pthread_sigmask(SIG_BLOCK, &all, NULL);
+	GhRtRelease();
+	pthread_mutex_lock(&w1lock);
+	for (;;) {
+		while (!w1go && !w1stop) {
+			pthread_cond_wait(&w1cond, &w1lock);
+		}
+		if (w1stop) {
+			break;
+		}
+		w1go = 0;
+		w1busy = 1;
+		rtime = w1time;
+		pthread_mutex_unlock(&w1lock);
+		start = GhRealClock.millis();
+		bulk = GhW1Trigger();
+		if (bulk > 0) {
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += W1CONVERT * 1000000L;
+			if (ts.tv_nsec >= 1000000000L) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000L;
+			}
+			pthread_mutex_lock(&w1lock);
+			while (!w1stop && pthread_cond_timedwait(&w1cond, &w1lock, &ts) != ETIMEDOUT) {
+			}
+			pthread_mutex_unlock(&w1lock);
+		}
+		for (int i = 0; i < nprobes && !w1stop; i++) {
+			value = GhW1ReadProbe(probes[i], &quality);
+			GhSensorUpdate(probeidx[i], value, quality, rtime);
+		}
+		ms = GhRealClock.millis() - start;
+		pthread_mutex_lock(&w1lock);
+		w1busy = 0;
+		w1stats.cycles++;
+		w1stats.bulk += bulk > 0;
+		w1stats.lastms = ms;
+		w1stats.maxms = ms > w1stats.maxms ? ms : w1stats.maxms;
+	}
+	pthread_mutex_unlock(&w1lock);
+	return NULL;
+}
+
+/** Asks the worker for a cycle, unless one is still running
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param now time of the tick
+ */
+static void GhW1Start(time_t now) {
+	pthread_mutex_lock(&w1lock);
+	if (w1go || w1busy) {
+		w1stats.skipped++;
+	}
+	else {
+		w1go = 1;
+		w1time = now;
+		pthread_cond_signal(&w1cond);
+	}
+	pthread_mutex_unlock(&w1lock);
+}
+
+/** Stops the worker, abandoning a cycle in progress
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ */
+static void GhW1Close(void) {
+	if (!w1running) {
+		return;
+	}
+	pthread_mutex_lock(&w1lock);
+	w1stop = 1;
+	pthread_cond_signal(&w1cond);
+	pthread_mutex_unlock(&w1lock);
+	pthread_join(w1thread, NULL);
+	w1running = 0;
+}
+
+/** Finds the DS18B20 probes and bus masters under a w1 sysfs root,
+ * registers the probes and starts the worker
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @param root sysfs root, NULL for W1ROOT; a plain directory tree of the
+ * same shape serves for testing
+ * @return number of probes registered, -1 if root can't be read or its
+ * path is too long; an entry whose path would not fit is reported and skipped
+ */
+int GhW1Init(const char * root) {
+	struct dirent ** names;
+	const char * name;
+	int idx, n;
+
+	if (root != NULL && snprintf(w1root, sizeof(w1root), "%s", root) >= (int) sizeof(w1root)) {
+		return -1;
+	}
+	// Sorted, so probes keep their order from one start to the next
+	n = scandir(w1root, &names, NULL, alphasort);
+	if (n == -1) {
+		return -1;
+	}
+	for (int i = 0; i < n; i++) {
+		name = names[i]->d_name;
+		if (strncmp(name, W1FAMILY, strlen(W1FAMILY)) == 0 && nprobes < SENSORMAX) {
+			if (snprintf(probes[nprobes], W1PATHSZ, "%s/%s/w1_slave", w1root, name) >= W1PATHSZ) {
+				fprintf(stdout, "\n1-Wire probe %s skipped, path too long\n", name);
+			}
+			else if ((idx = GhSensorRegister(name, "temperature", &GhW1Driver)) >= 0) {
+				probeidx[nprobes++] = idx;
+			}
+		}
+		else if (strncmp(name, W1MASTER, strlen(W1MASTER)) == 0 && nmasters < W1MASTERS) {
+			if (snprintf(masters[nmasters], W1PATHSZ, "%s/%s/therm_bulk_read", w1root, name) >= W1PATHSZ) {
+				fprintf(stdout, "\n1-Wire master %s skipped, path too long\n", name);
+			}
+			else if (access(masters[nmasters], W_OK) == 0) {
+				nmasters++;
+			}
+		}
+		free(names[i]);
+	}
+	free(names);
+	if (nprobes > 0 && !w1running) {
+		w1stop = 0;
+		w1running = pthread_create(&w1thread, NULL, GhW1Worker, NULL) == 0;
+	}
+	return nprobes;
+}
+
+/** Gets the driver counters
+ * @version 2026-10-19
+ * @author Braydon Giallombardo
+ * @return counters
+ */
+w1stats_s GhW1Stats(void) {
+	w1stats_s s;
+	pthread_mutex_lock(&w1lock);
+	s = w1stats;
+	pthread_mutex_unlock(&w1lock);
+	return s;
+}
@@ -0,0 +1,37 @@
+/** 1-Wire DS18B20 driver constants, structures, function prototypes
+ * @version ghw1.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef GHW1_H
+#define GHW1_H
+
+#include "ghsensor.h"
+
+// Constants ##############################################
+#define W1ROOT "/sys/bus/w1/devices"
+#define W1FAMILY "28-"          // DS18B20 family code
+#define W1MASTER "w1_bus_master"
+#define W1MASTERS 8
+#define W1PATHSZ 512
+#define W1CONVERT 750           // ms a 12 bit conversion takes
+#define W1POWERON 85000         // temperature of a probe that never converted, or of 85 C
+#define W1PADSZ 7               // scratchpad bytes read to tell them apart
+#define W1RESETPAD 0x0c         // byte 6 at power on, 0x10 minus the low nibble after a conversion
+#define W1MIN -55000            // measuring range in millidegrees
+#define W1MAX 125000
+
+// Structures ##########################################
+typedef struct w1stats {
+	long cycles;            // conversions triggered and collected
+	long skipped;           // starts that found the previous cycle still running
+	long bulk;              // cycles that converted every probe at once
+	long lastms;            // length of the last cycle
+	long maxms;
+}w1stats_s;
+
+/// @cond INTERNAL
+// Function Prototypes #################################
+int GhW1Init(const char * root);
+w1stats_s GhW1Stats(void);
+/// @endcond
+#endif
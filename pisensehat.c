@@ -8,6 +8,65 @@ static int fbfd;        // Frame buffer file handle;
 static uint16_t *map;   // Frame buffer memory map pointer;
 static int HTS221fd;    // HTS221 Sensor file handle;
 static int LPS25Hfd;    // LPS25Hfd Sensor file handle;
+static int LPS25Hmode;  // LPS25HONESHOT, LPS25HFIFO or LPS25HFIFOMEAN
+static int LPS25Harmed; // every FIFO register was written since the last failure
+
+/** Sleeps between hardware register polls
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param usecs delay in microseconds
+ * @return void
+ */
+static void ShDelay(unsigned int usecs)
+{
+    usleep(usecs);
+}
+
+/** Reads consecutive registers in one SMBus I2C block transfer
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd sensor file handle from wiringPiI2CSetup
+ * @param reg first register, with any auto-increment bit the device needs
+ * @param buf receives the bytes
+ * @param len bytes to read, at most SHBLOCKMAX
+ * @return int bytes read, -1 on error
+ */
+static int ShI2CReadBlock(int fd, int reg, uint8_t * buf, int len)
+{
+    union i2c_smbus_data data;
+    struct i2c_smbus_ioctl_data args;
+
+    data.block[0] = (uint8_t) len;
+    args.read_write = I2C_SMBUS_READ;
+    args.command = (uint8_t) reg;
+    args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    args.data = &data;
+    if (ioctl(fd, I2C_SMBUS, &args) == -1)
+    {
+        return -1;
+    }
+    memcpy(buf, &data.block[1], data.block[0] < len ? data.block[0] : len);
+    return data.block[0];
+}
+
+static const shbus_s wiringbus = { 1, wiringPiI2CSetup, wiringPiI2CReadReg8, wiringPiI2CWriteReg8, ShDelay, ShI2CReadBlock };
+static const shbus_s * bus = &wiringbus;   // I2C bus used by the sensor functions
+
+/** Opens and powers down the HTS221 and LPS25H sensors
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param void
+ * @return void
+ */
+static void ShInitSensors(void)
+{
+	HTS221fd = bus->setup(HTS221I2CADDRESS);
+	LPS25Hfd = bus->setup(LPS25HI2CADDRESS);
+
+    // Power down the device (clean start)
+    bus->write8(HTS221fd, CTRL_REG1, 0x00);
+    bus->write8(LPS25Hfd, CTRL_REG1, 0x00);
+}
 
 /** Initialize Sensehat
  * @author Paul Moggach
@@ -21,6 +80,15 @@ int ShInit(void)
     int status = 1;
     struct fb_fix_screeninfo fix_info;
 
+    // Simulated devices draw into memory instead of the LED matrix
+    if (!bus->hardware)
+    {
+        fbfd = -1;
+        map = calloc(NUM_WORDS, sizeof(uint16_t));
+        ShInitSensors();
+        return status;
+    }
+
     // Frame Buffer Initialization for 8X8 LED Matrix
     /* open the led frame buffer device */
     fbfd = open(FILEPATH, O_RDWR);
@@ -56,15 +124,147 @@ int ShInit(void)
     }
 
     // Sensor Initialization
-	HTS221fd = wiringPiI2CSetup(HTS221I2CADDRESS);
-	LPS25Hfd = wiringPiI2CSetup(LPS25HI2CADDRESS);
-
-    // Power down the device (clean start)
-    wiringPiI2CWriteReg8(HTS221fd, CTRL_REG1, 0x00);
-    wiringPiI2CWriteReg8(LPS25Hfd, CTRL_REG1, 0x00);
+    ShInitSensors();
     return status;
 }
 
+/** Selects the I2C bus used by the sensor functions, call before ShInit
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param nbus bus operations, NULL restores the wiringPi bus
+ * @return void
+ */
+void ShSetBus(const shbus_s * nbus)
+{
+    bus = (nbus == NULL) ? &wiringbus : nbus;
+}
+
+/** Gets the I2C bus used by the sensor functions
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param void
+ * @return const shbus_s * current bus
+ */
+const shbus_s * ShGetBus(void)
+{
+    return bus;
+}
+
+/** Re-initializes a sensor after a timeout or bus error
+ * The handle is reopened so a device that dropped off the bus is picked
+ * up again, then the device is powered down for a clean start.
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd pointer to the sensor file handle
+ * @param address I2C address of the sensor
+ * @return int 1 if successful
+ */
+int ShResetSensor(int * fd, int address)
+{
+    int nfd;
+
+    nfd = bus->setup(address);
+    if (nfd < 0)
+    {
+        return 0;
+    }
+    if (bus->hardware && *fd >= 0)
+    {
+        close(*fd);
+    }
+    *fd = nfd;
+    return bus->write8(*fd, CTRL_REG1, 0x00) >= 0;
+}
+
+/** Reads a register, recording a bus error instead of returning garbage
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd sensor file handle
+ * @param reg register address
+ * @param err set to SHBUSERR if the transfer failed
+ * @return uint8_t register value, 0 on error
+ */
+static uint8_t ShReadReg(int fd, int reg, int * err)
+{
+    int val;
+
+    val = bus->read8(fd, reg);
+    if (val < 0)
+    {
+        *err = SHBUSERR;
+        return 0;
+    }
+    return (uint8_t) val;
+}
+
+/** Writes a register, recording a bus error
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd sensor file handle
+ * @param reg register address
+ * @param data value to write
+ * @param err set to SHBUSERR if the transfer failed
+ * @return void
+ */
+static void ShWriteReg(int fd, int reg, int data, int * err)
+{
+    if (bus->write8(fd, reg, data) < 0)
+    {
+        *err = SHBUSERR;
+    }
+}
+
+/** Reads consecutive registers in as few block transfers as possible,
+ * recording a bus error
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd sensor file handle
+ * @param reg first register, with any auto-increment bit the device needs
+ * @param buf receives the bytes
+ * @param len bytes to read
+ * @param err set to SHBUSERR if a transfer failed
+ * @return void
+ */
+static void ShReadBlock(int fd, int reg, uint8_t * buf, int len, int * err)
+{
+    int n;
+
+    for (int off = 0; off < len && *err == SHOK; off += n)
+    {
+        n = len - off < SHBLOCKMAX ? len - off : SHBLOCKMAX;
+        if (bus->readblock(fd, reg, buf + off, n) != n)
+        {
+            *err = SHBUSERR;
+        }
+    }
+}
+
+/** Waits for a one-shot measurement with an upper bound on polls
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd sensor file handle
+ * @return int SHOK, SHTIMEOUT if the busy bit never cleared, SHBUSERR
+ */
+static int ShWaitOneShot(int fd)
+{
+    int status;
+
+    for (int i = 0; i < SHMAXPOLLS; i++)
+    {
+        bus->delay(HTS221DELAY);    // 25 ms
+        status = bus->read8(fd, CTRL_REG2);
+        if (status < 0)
+        {
+            return SHBUSERR;
+        }
+        if ((status & 0x01) == 0)
+        {
+            return SHOK;
+        }
+    }
+    return SHTIMEOUT;
+}
+
 /** Closes Down the Sensehat
  * @author Paul Moggach
  * @author Kristian Medri
@@ -76,6 +276,11 @@ int ShExit(void)
 {
     int status = 1;
     ShClearMatrix();
+    if (!bus->hardware)
+    {
+        free(map);
+        return status;
+    }
     /* un-map and close */
     if (munmap(map, FILESIZE) == -1)
     {
@@ -177,77 +382,261 @@ int ShSetVerticalBar(int bar,fbpixel_s px, uint8_t value)
 	return 0;
 }
 
-/** Gets LPS25H Sensehat sensor information
+/** Runs one LPS25H one-shot measurement
  * @author Paul Moggach
  * @author Kristian Medri
- * @version 2020-01-14
- * @param void
- * @return lps25hData_s pressure and temperature data
+ * @version 2026-10-19
+ * @param rd receives pressure and temperature data
+ * @return int SHOK, SHTIMEOUT or SHBUSERR
  */
-lps25hData_s ShGetLPS25HData(void)
+static int ShReadLPS25H(lps25hData_s * rd)
 {
-    lps25hData_s rd = {0};
-
+    int err = SHOK;
     uint8_t temp_out_l = 0, temp_out_h = 0;
     int16_t temp_out = 0;
     uint8_t press_out_xl = 0;
     uint8_t press_out_l = 0;
     uint8_t press_out_h = 0;
     int32_t press_out = 0;
-    uint8_t status = 0;
 
 	// Power down the device (clean start)
-    wiringPiI2CWriteReg8(LPS25Hfd, CTRL_REG1, 0x00);
+    ShWriteReg(LPS25Hfd, CTRL_REG1, 0x00, &err);
 
     // Turn on the humidity sensor analog front end in single shot mode
-    wiringPiI2CWriteReg8(LPS25Hfd, CTRL_REG1, 0x84);
+    ShWriteReg(LPS25Hfd, CTRL_REG1, 0x84, &err);
 
     // Run one-shot measurement (temperature and humidity). The set bit will be reset by the
     // sensor itself after execution (self-clearing bit)
-    wiringPiI2CWriteReg8(LPS25Hfd, CTRL_REG2, 0x01);
+    ShWriteReg(LPS25Hfd, CTRL_REG2, 0x01, &err);
 
     // Wait until the measurement is completed
-    do
-	{
-		usleep(HTS221DELAY);	// 25 ms
-		status = wiringPiI2CReadReg8(LPS25Hfd, CTRL_REG2);
+    if (err == SHOK)
+    {
+        err = ShWaitOneShot(LPS25Hfd);
+    }
+    if (err != SHOK)
+    {
+        return err;
     }
-    while (status != 0);
 
     /* Read the temperature measurement (2 bytes to read) */
-    temp_out_l = wiringPiI2CReadReg8(LPS25Hfd, TEMP_OUT_L);
-    temp_out_h = wiringPiI2CReadReg8(LPS25Hfd, TEMP_OUT_H);
+    temp_out_l = ShReadReg(LPS25Hfd, TEMP_OUT_L, &err);
+    temp_out_h = ShReadReg(LPS25Hfd, TEMP_OUT_H, &err);
 
     /* Read the pressure measurement (3 bytes to read) */
-    press_out_xl = wiringPiI2CReadReg8(LPS25Hfd, PRESS_OUT_XL);
-    press_out_l = wiringPiI2CReadReg8(LPS25Hfd, PRESS_OUT_L);
-    press_out_h = wiringPiI2CReadReg8(LPS25Hfd, PRESS_OUT_H);
+    press_out_xl = ShReadReg(LPS25Hfd, PRESS_OUT_XL, &err);
+    press_out_l = ShReadReg(LPS25Hfd, PRESS_OUT_L, &err);
+    press_out_h = ShReadReg(LPS25Hfd, PRESS_OUT_H, &err);
 
     /* make 16 and 24 bit values (using bit shift) */
     temp_out = temp_out_h << 8 | temp_out_l;
     press_out = press_out_h << 16 | press_out_l << 8 | press_out_xl;
 
     /* calculate output values */
-    rd.temperature = 42.5 + (temp_out / 480.0);
-    rd.pressure = press_out / 4096.0;
+    if (err == SHOK)
+    {
+        rd->temperature = 42.5 + (temp_out / 480.0);
+        rd->pressure = press_out / 4096.0;
+    }
 
 	// Power down the device
-    wiringPiI2CWriteReg8(LPS25Hfd, CTRL_REG1, 0x00);
+    ShWriteReg(LPS25Hfd, CTRL_REG1, 0x00, &err);
 
-    return rd;
+    return err;
 }
 
-/** Gets HT221S Sensehat sensor data
+/** Gets LPS25H Sensehat sensor information
+ * A failed measurement is retried after a doubling backoff and a sensor
+ * reset, so a wedged device costs at most SHWORSTCASE ms. In a FIFO mode
+ * the pressure is the mean of the samples since the last call.
  * @author Paul Moggach
  * @author Kristian Medri
- * @version 2020-01-14
+ * @version 2026-10-19
  * @param void
- * @return ht221sData_s temperature and humidity data
+ * @return lps25hData_s pressure and temperature data, status SHOK if valid
  */
-ht221sData_s ShGetHT221SData(void)
+lps25hData_s ShGetLPS25HData(void)
 {
-    ht221sData_s rd = {0};
-    int status;
+    lps25hData_s rd = {0};
+    lps25hBatch_s b;
+    unsigned int backoff = SHBACKOFF;
+
+    if (LPS25Hmode != LPS25HONESHOT)
+    {
+        b = ShGetLPS25HBatch(0);
+        rd.status = b.status;
+        if (b.status == SHOK)
+        {
+            rd.pressure = b.mean;
+            rd.temperature = b.temperature[b.n - 1];
+        }
+        return rd;
+    }
+    for (int i = 0; i < SHRETRIES; i++)
+    {
+        rd.status = ShReadLPS25H(&rd);
+        if (rd.status == SHOK || i == SHRETRIES - 1)
+        {
+            break;
+        }
+        bus->delay(backoff);
+        backoff *= 2;
+        ShResetSensor(&LPS25Hfd, LPS25HI2CADDRESS);
+    }
+    return rd;
+}
+
+/** Starts the LPS25H measuring on its own at 12.5 Hz into its FIFO
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param void
+ * @return int SHOK or SHBUSERR
+ */
+static int ShArmLPS25H(void)
+{
+    int err = SHOK;
+
+    // Power down and pass through bypass mode, which empties the FIFO
+    ShWriteReg(LPS25Hfd, CTRL_REG1, 0x00, &err);
+    ShWriteReg(LPS25Hfd, FIFO_CTRL, 0x00, &err);
+    ShWriteReg(LPS25Hfd, FIFO_CTRL, LPS25Hmode == LPS25HFIFOMEAN ? LPS25HFMEAN : LPS25HFSTREAM, &err);
+    ShWriteReg(LPS25Hfd, CTRL_REG2, LPS25HFIFOEN, &err);
+    ShWriteReg(LPS25Hfd, CTRL_REG1, LPS25HODR, &err);
+    LPS25Harmed = (err == SHOK);
+    return err;
+}
+
+/** Selects how the LPS25H is read
+ * In LPS25HFIFO and LPS25HFIFOMEAN modes the sensor samples on its own and
+ * every read drains it without waiting, ShGetLPS25HData then returns the
+ * mean of the batch.
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param mode LPS25HONESHOT, LPS25HFIFO to drain every sample or
+ * LPS25HFIFOMEAN to read the sensor's own 32 sample mean
+ * @return int 1 if successful
+ */
+int ShLPS25HSetMode(int mode)
+{
+    int err = SHOK;
+
+    LPS25Hmode = mode;
+    LPS25Harmed = 0;
+    if (mode == LPS25HONESHOT)
+    {
+        ShWriteReg(LPS25Hfd, CTRL_REG1, 0x00, &err);
+        ShWriteReg(LPS25Hfd, CTRL_REG2, 0x00, &err);
+        ShWriteReg(LPS25Hfd, FIFO_CTRL, 0x00, &err);
+        return err == SHOK;
+    }
+    if (ShArmLPS25H() != SHOK)
+    {
+        return 0;
+    }
+    // Once, so the first read has a sample to drain
+    bus->delay(LPS25HPERIOD);
+    return 1;
+}
+
+/** Drains the LPS25H FIFO in block reads
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param b receives the samples
+ * @param nowms time of the read, 0 to stamp samples relative to it
+ * @return int SHOK, SHTIMEOUT at once if the FIFO is empty or SHBUSERR
+ */
+static int ShDrainLPS25H(lps25hBatch_s * b, long long nowms)
+{
+    int err = SHOK, status, n;
+    uint8_t raw[LPS25HFIFOSZ * LPS25HSLOT];
+    const uint8_t * slot;
+    int32_t press;
+    int16_t temp;
+
+    // Half set up, the output registers do not wrap and a long read would
+    // run on into unrelated ones. Armed again, it holds nothing yet.
+    if (!LPS25Harmed)
+    {
+        return ShArmLPS25H() == SHOK ? SHTIMEOUT : SHBUSERR;
+    }
+    status = ShReadReg(LPS25Hfd, FIFO_STATUS, &err);
+    if (err != SHOK)
+    {
+        return err;
+    }
+    if (status & LPS25HEMPTY)
+    {
+        return SHTIMEOUT;
+    }
+    b->full = (status & LPS25HFULL) != 0;
+    n = b->full ? LPS25HFIFOSZ : (status & LPS25HFSS);
+    // The mean mode holds one averaged slot; in stream mode a read past
+    // LPS_TEMP_OUT_H wraps to PRESS_OUT_XL of the next slot
+    n = LPS25Hmode == LPS25HFIFOMEAN ? 1 : n;
+    ShReadBlock(LPS25Hfd, PRESS_OUT_XL | LPS25HAUTOINC, raw, n * LPS25HSLOT, &err);
+    if (err != SHOK)
+    {
+        return err;
+    }
+    b->n = n;
+    b->mean = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+        slot = raw + i * LPS25HSLOT;
+        press = slot[2] << 16 | slot[1] << 8 | slot[0];
+        temp = slot[4] << 8 | slot[3];
+        b->pressure[i] = press / 4096.0;
+        b->temperature[i] = 42.5 + (temp / 480.0);
+        b->ms[i] = nowms - (long long) (n - 1 - i) * LPS25HPERIOD / 1000;
+        b->mean += b->pressure[i] / n;
+    }
+    return SHOK;
+}
+
+/** Gets every LPS25H sample taken since the last call, or the sensor's
+ * running mean in LPS25HFIFOMEAN mode, with one status read and a block
+ * read per six samples. It never waits for a sample, an empty FIFO is
+ * reported at once. A failed read leaves the FIFO as it was, so it is
+ * drained again after a doubling backoff; only when every attempt failed
+ * is the sensor reset, to be armed again on the next call.
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param nowms time of the read, 0 to stamp samples relative to it
+ * @return lps25hBatch_s samples, status SHOK if valid
+ */
+lps25hBatch_s ShGetLPS25HBatch(long long nowms)
+{
+    lps25hBatch_s b = {0};
+    unsigned int backoff = SHBACKOFF;
+
+    for (int i = 0; i < SHRETRIES; i++)
+    {
+        b.status = ShDrainLPS25H(&b, nowms);
+        if (b.status != SHBUSERR || i == SHRETRIES - 1)
+        {
+            break;
+        }
+        bus->delay(backoff);
+        backoff *= 2;
+    }
+    if (b.status == SHBUSERR)
+    {
+        ShResetSensor(&LPS25Hfd, LPS25HI2CADDRESS);
+        LPS25Harmed = 0;
+    }
+    return b;
+}
+
+/** Runs one HT221S one-shot measurement
+ * @author Paul Moggach
+ * @author Kristian Medri
+ * @version 2026-10-19
+ * @param rd receives temperature and humidity data
+ * @return int SHOK, SHTIMEOUT or SHBUSERR
+ */
+static int ShReadHT221S(ht221sData_s * rd)
+{
+    int err = SHOK;
 	uint8_t t0_out_l,t0_out_h,t1_out_l,t1_out_h;
 	uint8_t t0_degC_x8,t1_degC_x8,t1_t0_msb;
 	int16_t T0_OUT,T1_OUT;
@@ -261,45 +650,47 @@ ht221sData_s ShGetHT221SData(void)
 	double H0_rH,H1_rH,h_gradient_m,h_intercept_c;
 
 	// Power down the device (clean start)
-    wiringPiI2CWriteReg8(HTS221fd, CTRL_REG1, 0x00);
+    ShWriteReg(HTS221fd, CTRL_REG1, 0x00, &err);
     // Turn on the humidity sensor analog front end in single shot mode
-    wiringPiI2CWriteReg8(HTS221fd, CTRL_REG1, 0x84);
+    ShWriteReg(HTS221fd, CTRL_REG1, 0x84, &err);
     // Run one-shot measurement (temperature and humidity). The set bit will be reset by the
     // sensor itself after execution (self-clearing bit)
-    wiringPiI2CWriteReg8(HTS221fd, CTRL_REG2, 0x01);
+    ShWriteReg(HTS221fd, CTRL_REG2, 0x01, &err);
 
     // Wait until the measurement is completed
-    do
-	{
-		usleep(HTS221DELAY);	// 25 ms
-		status = wiringPiI2CReadReg8(HTS221fd, CTRL_REG2);
+    if (err == SHOK)
+    {
+        err = ShWaitOneShot(HTS221fd);
+    }
+    if (err != SHOK)
+    {
+        return err;
     }
-    while (status != 0);
 
     // Read calibration temperature LSB (ADC) data
     // (temperature calibration x-data for two points)
-    t0_out_l = wiringPiI2CReadReg8(HTS221fd, T0_OUT_L);
-    t0_out_h = wiringPiI2CReadReg8(HTS221fd, T0_OUT_H);
-    t1_out_l = wiringPiI2CReadReg8(HTS221fd, T1_OUT_L);
-    t1_out_h = wiringPiI2CReadReg8(HTS221fd, T1_OUT_H);
+    t0_out_l = ShReadReg(HTS221fd, T0_OUT_L, &err);
+    t0_out_h = ShReadReg(HTS221fd, T0_OUT_H, &err);
+    t1_out_l = ShReadReg(HTS221fd, T1_OUT_L, &err);
+    t1_out_h = ShReadReg(HTS221fd, T1_OUT_H, &err);
 
    // Read calibration relative humidity LSB (ADC) data
     // (humidity calibration x-data for two points)
-    h0_out_l = wiringPiI2CReadReg8(HTS221fd, H0_T0_OUT_L);
-    h0_out_h = wiringPiI2CReadReg8(HTS221fd, H0_T0_OUT_H);
-    h1_out_l = wiringPiI2CReadReg8(HTS221fd, H1_T0_OUT_L);
-    h1_out_h = wiringPiI2CReadReg8(HTS221fd, H1_T0_OUT_H);
+    h0_out_l = ShReadReg(HTS221fd, H0_T0_OUT_L, &err);
+    h0_out_h = ShReadReg(HTS221fd, H0_T0_OUT_H, &err);
+    h1_out_l = ShReadReg(HTS221fd, H1_T0_OUT_L, &err);
+    h1_out_h = ShReadReg(HTS221fd, H1_T0_OUT_H, &err);
 
     // Read calibration temperature (C) data
     // (temperature calibration y-data for two points)
-    t0_degC_x8 = wiringPiI2CReadReg8(HTS221fd, T0_degC_x8);
-    t1_degC_x8 = wiringPiI2CReadReg8(HTS221fd, T1_degC_x8);
-    t1_t0_msb = wiringPiI2CReadReg8(HTS221fd, T1_T0_MSB);
+    t0_degC_x8 = ShReadReg(HTS221fd, T0_degC_x8, &err);
+    t1_degC_x8 = ShReadReg(HTS221fd, T1_degC_x8, &err);
+    t1_t0_msb = ShReadReg(HTS221fd, T1_T0_MSB, &err);
 
    // Read relative humidity (% rH) data
     // (humidity calibration y-data for two points)
-    h0_rh_x2 = wiringPiI2CReadReg8(HTS221fd, H0_rH_x2);
-    h1_rh_x2 = wiringPiI2CReadReg8(HTS221fd, H1_rH_x2);
+    h0_rh_x2 = ShReadReg(HTS221fd, H0_rH_x2, &err);
+    h1_rh_x2 = ShReadReg(HTS221fd, H1_rH_x2, &err);
 
     // make 16 bit values (bit shift)
     // (temperature calibration x-values)
@@ -321,8 +712,8 @@ ht221sData_s ShGetHT221SData(void)
     t_intercept_c = T1_DegC - (t_gradient_m * T1_OUT);
 
 	// Read the ambient temperature measurement (2 bytes to read)
-    t_out_l = wiringPiI2CReadReg8(HTS221fd, TEMP_OUT_L);
-    t_out_h = wiringPiI2CReadReg8(HTS221fd, TEMP_OUT_H);
+    t_out_l = ShReadReg(HTS221fd, TEMP_OUT_L, &err);
+    t_out_h = ShReadReg(HTS221fd, TEMP_OUT_H, &err);
 
     // make 16 bit value
     T_OUT = t_out_h << 8 | t_out_l;
@@ -340,17 +731,49 @@ ht221sData_s ShGetHT221SData(void)
     h_intercept_c = H1_rH - (h_gradient_m * H1_T0_OUT);
 
     // Read the ambient humidity measurement (2 bytes to read)
-    h_t_out_l = wiringPiI2CReadReg8(HTS221fd, H_T_OUT_L);
-    h_t_out_h = wiringPiI2CReadReg8(HTS221fd, H_T_OUT_H);
+    h_t_out_l = ShReadReg(HTS221fd, H_T_OUT_L, &err);
+    h_t_out_h = ShReadReg(HTS221fd, H_T_OUT_H, &err);
 
     // make 16 bit value
     H_T_OUT = h_t_out_h << 8 | h_t_out_l;
 
 	// Power down the device
-    wiringPiI2CWriteReg8(HTS221fd, CTRL_REG1, 0x00);
+    ShWriteReg(HTS221fd, CTRL_REG1, 0x00, &err);
 
 	// Calculate and return ambient temperature
-    rd.temperature = (t_gradient_m * T_OUT) + t_intercept_c;
-    rd.humidity = (h_gradient_m * H_T_OUT) + h_intercept_c;
+    if (err == SHOK)
+    {
+        rd->temperature = (t_gradient_m * T_OUT) + t_intercept_c;
+        rd->humidity = (h_gradient_m * H_T_OUT) + h_intercept_c;
+    }
+    return err;
+}
+
+/** Gets HT221S Sensehat sensor data
+ * A failed measurement is retried after a doubling backoff and a sensor
+ * reset, so a wedged device costs at most SHWORSTCASE ms. The last failure
+ * is returned as it is, its reset is left to the next call.
+ * @author Paul Moggach
+ * @author Kristian Medri
+ * @version 2026-10-19
+ * @param void
+ * @return ht221sData_s temperature and humidity data, status SHOK if valid
+ */
+ht221sData_s ShGetHT221SData(void)
+{
+    ht221sData_s rd = {0};
+    unsigned int backoff = SHBACKOFF;
+
+    for (int i = 0; i < SHRETRIES; i++)
+    {
+        rd.status = ShReadHT221S(&rd);
+        if (rd.status == SHOK || i == SHRETRIES - 1)
+        {
+            break;
+        }
+        bus->delay(backoff);
+        backoff *= 2;
+        ShResetSensor(&HTS221fd, HTS221I2CADDRESS);
+    }
     return rd;
 }
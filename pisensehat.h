@@ -22,6 +22,8 @@
 #include <dirent.h>
 #include <linux/input.h>
 #include <time.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
 
 // LPS25H Constants
 #define LPS25HI2CADDRESS 0x5c
@@ -30,6 +32,23 @@
 #define PRESS_OUT_H 0x2A
 //#define TEMP_OUT_L 0x2B
 //#define TEMP_OUT_H 0x2C
+#define LPS_TEMP_OUT_H 0x2C     // last register of a FIFO slot
+#define FIFO_CTRL 0x2E
+#define FIFO_STATUS 0x2F
+#define LPS25HAUTOINC 0x80      // register address bit that makes a multi-byte read advance
+#define LPS25HODR 0xB4          // CTRL_REG1: powered up, 12.5 Hz, block data update
+#define LPS25HPERIOD 80000      // us between samples at 12.5 Hz
+#define LPS25HFIFOEN 0x40       // CTRL_REG2 FIFO_EN
+#define LPS25HFSTREAM 0x40      // FIFO_CTRL stream mode, the newest 32 samples are kept
+#define LPS25HFMEAN 0xDF        // FIFO_CTRL FIFO mean mode over 32 samples
+#define LPS25HFULL 0x40         // FIFO_STATUS FULL_FIFO
+#define LPS25HEMPTY 0x20        // FIFO_STATUS EMPTY_FIFO
+#define LPS25HFSS 0x1F          // FIFO_STATUS unread samples below 32
+#define LPS25HFIFOSZ 32
+#define LPS25HSLOT 5            // bytes a FIFO slot reads as, pressure then temperature
+#define LPS25HONESHOT 0         // acquisition modes
+#define LPS25HFIFO 1
+#define LPS25HFIFOMEAN 2
 
 // HTS221 Constants
 #define HTS221I2CADDRESS 0x5F
@@ -60,6 +79,17 @@
 #define H_T_OUT_L 0x28
 #define H_T_OUT_H 0x29
 
+// Bounded Sensor I/O Constants
+#define SHMAXPOLLS 4        // one-shot polls per attempt (4 x 25 ms)
+#define SHRETRIES 3         // attempts before a read is reported failed
+#define SHBACKOFF 10000     // first retry backoff in us, doubled per retry
+#define SHWORSTCASE ((SHRETRIES * SHMAXPOLLS * HTS221DELAY + SHBACKOFF * ((1 << (SHRETRIES - 1)) - 1)) / 1000) // ms per read, no backoff after the last attempt
+#define SHTICKWORST (3 * SHWORSTCASE) // ms per tick: the HTS221 is read for temperature and for humidity, then the LPS25H
+#define SHOK 0
+#define SHTIMEOUT 1
+#define SHBUSERR 2
+#define SHBLOCKMAX 30       // bytes per block read: whole FIFO slots within an SMBus block
+
 // Sense Hat Frame Buffer Constants
 #define FILEPATH "/dev/fb1"
 #define NUM_WORDS 64
@@ -82,24 +112,52 @@ typedef struct lps25hData
 {
     double temperature;
     double pressure;
+    int status;
 } lps25hData_s;
 
+typedef struct lps25hBatch
+{
+    int n;                                  // samples drained, oldest first
+    double pressure[LPS25HFIFOSZ];
+    double temperature[LPS25HFIFOSZ];
+    long long ms[LPS25HFIFOSZ];             // time each sample was taken, from the sample rate
+    double mean;                            // pressure, averaged by the sensor in FIFO mean mode
+    int full;                               // the FIFO filled, older samples may have been lost
+    int status;
+} lps25hBatch_s;
+
 typedef struct ht221sData
 {
     double temperature;
     double humidity;
+    int status;
 } ht221sData_s;
 
+typedef struct shbus
+{
+    int hardware;                               // 0 for simulated devices without a frame buffer
+    int (*setup)(int devId);
+    int (*read8)(int fd, int reg);
+    int (*write8)(int fd, int reg, int data);
+    void (*delay)(unsigned int usecs);
+    int (*readblock)(int fd, int reg, uint8_t * buf, int len);    // at most SHBLOCKMAX bytes
+} shbus_s;
+
 // Function Prototypes
 /// @cond INTERNAL
 int ShInit(void);
 int ShExit(void);
+void ShSetBus(const shbus_s * nbus);
+const shbus_s * ShGetBus(void);
+int ShResetSensor(int * fd, int address);
 void ShClearMatrix(void);
 uint8_t ShSetPixel(int x,int y,fbpixel_s px);
 fbpixel_s ShGetPixel(int x,int y);
 int ShSetVerticalBar(int bar,fbpixel_s px, uint8_t value);
 double ShLPS25HGetPressure(void);
 lps25hData_s ShGetLPS25HData(void);
+int ShLPS25HSetMode(int mode);
+lps25hBatch_s ShGetLPS25HBatch(long long nowms);
 ht221sData_s ShGetHT221SData(void);
 /// @endcond
 #endif
@@ -0,0 +1,505 @@
+/** Simulated Sensehat I2C bus functions
+ * Register level models of the HTS221 and LPS25H with fault injection,
+ * so the sensor functions can be exercised without a Raspberry Pi. The
+ * LPS25H model also samples into its FIFO in stream and mean modes as
+ * model time passes: the clock set with ShSimSetClock plus every delay
+ * the sensor functions asked for.
+ * @version shsim.c 2026-10-19
+ * @author Braydon Giallombardo
+ */
+
+#include "shsim.h"
+
+static shsimdev_s hts221;       // HTS221 register model
+static shsimdev_s lps25h;       // LPS25H register model
+static double simt = 25.0;      // values latched by the next one-shot
+static double simh = 55.0;
+static double simp = 1013.0;
+static long delayed;            // microseconds the sensor functions waited
+static uint32_t seed = 2463534242u;
+static uint32_t nseed = 88172645u;  // sample noise, apart from the fault sequence
+static long long (*simclock)(void); // milliseconds, NULL for delays alone
+
+/** Writes a little endian 16 bit value into two registers
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @param reg address of the low byte
+ * @param value value to store
+ * @return void
+ */
+static void ShSimPut16(shsimdev_s * dev, int reg, int16_t value)
+{
+    dev->reg[reg] = (uint16_t) value & 0xFF;
+    dev->reg[reg + 1] = ((uint16_t) value >> 8) & 0xFF;
+}
+
+/** Loads the calibration registers of both devices
+ * HTS221: 10 C at 0 counts, 35 C at 10000, 20 %rH at 0, 80 %rH at 12000.
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param void
+ * @return void
+ */
+static void ShSimCalibrate(void)
+{
+    hts221.reg[WHO_AM_I] = 0xBC;
+    hts221.reg[T0_degC_x8] = 80;
+    hts221.reg[T1_degC_x8] = 280 & 0xFF;
+    hts221.reg[T1_T0_MSB] = (280 >> 8) << 2;
+    ShSimPut16(&hts221, T0_OUT_L, 0);
+    ShSimPut16(&hts221, T1_OUT_L, 10000);
+    hts221.reg[H0_rH_x2] = 40;
+    hts221.reg[H1_rH_x2] = 160;
+    ShSimPut16(&hts221, H0_T0_OUT_L, 0);
+    ShSimPut16(&hts221, H1_T0_OUT_L, 12000);
+    lps25h.reg[WHO_AM_I] = 0xBD;
+}
+
+/** Draws the noise of one sample
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param rms standard deviation of the noise
+ * @return double near normal noise with that rms
+ */
+static double ShSimNoise(double rms)
+{
+    double sum = 0.0;
+
+    // The sum of four uniforms has a standard deviation of 0.577
+    for (int i = 0; i < 4; i++)
+    {
+        nseed ^= nseed << 13;
+        nseed ^= nseed >> 17;
+        nseed ^= nseed << 5;
+        sum += nseed / 4294967296.0;
+    }
+    return (sum - 2.0) / 0.577 * rms;
+}
+
+/** Latches the simulated environment into the output registers
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model that finished a one-shot
+ * @return void
+ */
+static void ShSimLatch(shsimdev_s * dev)
+{
+    int32_t press;
+
+    if (dev == &hts221)
+    {
+        // A real sensor never repeats itself for long, nor should the model
+        ShSimPut16(dev, TEMP_OUT_L, (int16_t) ((simt + ShSimNoise(SHSIMTNOISE) - 10.0) * 10000.0 / 25.0));
+        ShSimPut16(dev, H_T_OUT_L, (int16_t) ((simh + ShSimNoise(SHSIMHNOISE) - 20.0) * 12000.0 / 60.0));
+    }
+    else
+    {
+        press = (int32_t) ((simp + ShSimNoise(SHSIMPNOISE)) * 4096.0);
+        dev->reg[PRESS_OUT_XL] = press & 0xFF;
+        dev->reg[PRESS_OUT_L] = (press >> 8) & 0xFF;
+        dev->reg[PRESS_OUT_H] = (press >> 16) & 0xFF;
+        ShSimPut16(dev, PRESS_OUT_H + 1, (int16_t) ((simt - 42.5) * 480.0));
+    }
+}
+
+/** Gets the model time
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param void
+ * @return long long microseconds
+ */
+static long long ShSimNow(void)
+{
+    return (simclock != NULL ? simclock() * 1000 : 0) + delayed;
+}
+
+/** Tells whether the LPS25H is sampling into its FIFO
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @return int 1 if powered up at a data rate with the FIFO enabled and
+ * not in bypass mode
+ */
+static int ShSimFifoOn(shsimdev_s * dev)
+{
+    return dev == &lps25h && (dev->reg[CTRL_REG1] & 0x80) && (dev->reg[CTRL_REG1] & 0x70)
+        && (dev->reg[CTRL_REG2] & LPS25HFIFOEN) && (dev->reg[FIFO_CTRL] & 0xE0);
+}
+
+/** Tells whether the LPS25H FIFO is in mean mode
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @return int 1 in FIFO mean mode
+ */
+static int ShSimFifoMean(shsimdev_s * dev)
+{
+    return (dev->reg[FIFO_CTRL] & 0xE0) == (LPS25HFMEAN & 0xE0);
+}
+
+/** Takes every sample due by now into the LPS25H FIFO
+ * Stream mode keeps the newest LPS25HFIFOSZ samples, mean mode the
+ * newest WTM_POINT + 1 it averages.
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @return void
+ */
+static void ShSimSample(shsimdev_s * dev)
+{
+    long long now = ShSimNow(), behind;
+    int cap, idx;
+
+    if (!ShSimFifoOn(dev))
+    {
+        dev->fnext = 0;
+        return;
+    }
+    if (dev->fnext == 0)
+    {
+        dev->fnext = now + LPS25HPERIOD;
+    }
+    // Far behind, only the newest samples would survive anyway
+    behind = (now - dev->fnext) / LPS25HPERIOD - LPS25HFIFOSZ;
+    if (behind > 0)
+    {
+        dev->fnext += behind * LPS25HPERIOD;
+        dev->samples += behind;
+        dev->lost += behind;
+    }
+    cap = ShSimFifoMean(dev) ? (dev->reg[FIFO_CTRL] & LPS25HFSS) + 1 : LPS25HFIFOSZ;
+    for (; dev->fnext <= now; dev->fnext += LPS25HPERIOD)
+    {
+        if (dev->fcount == cap)
+        {
+            dev->fhead = (dev->fhead + 1) % LPS25HFIFOSZ;
+            dev->fcount--;
+            dev->lost += !ShSimFifoMean(dev);
+        }
+        idx = (dev->fhead + dev->fcount) % LPS25HFIFOSZ;
+        dev->fifop[idx] = (int32_t) ((simp + ShSimNoise(SHSIMPNOISE)) * 4096.0);
+        dev->fifot[idx] = (int16_t) ((simt - 42.5) * 480.0);
+        dev->fcount++;
+        dev->samples++;
+    }
+}
+
+/** Loads the oldest FIFO slot, or the mean of the FIFO in mean mode, into
+ * the output registers
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @return void
+ */
+static void ShSimSlot(shsimdev_s * dev)
+{
+    double p = 0.0, t = 0.0;
+    int32_t press;
+    int idx;
+
+    if (dev->fcount == 0)
+    {
+        return;
+    }
+    if (ShSimFifoMean(dev))
+    {
+        for (int i = 0; i < dev->fcount; i++)
+        {
+            idx = (dev->fhead + i) % LPS25HFIFOSZ;
+            p += dev->fifop[idx];
+            t += dev->fifot[idx];
+        }
+        press = (int32_t) (p / dev->fcount + 0.5);
+        ShSimPut16(dev, PRESS_OUT_H + 1, (int16_t) (t / dev->fcount));
+    }
+    else
+    {
+        press = dev->fifop[dev->fhead];
+        ShSimPut16(dev, PRESS_OUT_H + 1, dev->fifot[dev->fhead]);
+    }
+    dev->reg[PRESS_OUT_XL] = press & 0xFF;
+    dev->reg[PRESS_OUT_L] = (press >> 8) & 0xFF;
+    dev->reg[PRESS_OUT_H] = (press >> 16) & 0xFF;
+}
+
+/** Reads one register of a device model, with the side effects of the
+ * one-shot bit and the FIFO
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @param reg register address
+ * @return int register value
+ */
+static int ShSimReg(shsimdev_s * dev, int reg)
+{
+    int val;
+
+    if (reg == CTRL_REG2 && (dev->reg[CTRL_REG2] & 0x01))
+    {
+        if (!dev->fault.stuck && dev->busy-- <= 0)
+        {
+            dev->reg[CTRL_REG2] &= ~0x01;
+            ShSimLatch(dev);
+        }
+    }
+    if (!ShSimFifoOn(dev))
+    {
+        return dev->reg[reg];
+    }
+    ShSimSample(dev);
+    if (reg == FIFO_STATUS)
+    {
+        // FSS counts up to 31, FULL_FIFO stands for 32
+        dev->reg[FIFO_STATUS] = (dev->fcount == 0 ? LPS25HEMPTY : 0)
+            | (dev->fcount == LPS25HFIFOSZ ? LPS25HFULL : 0) | (dev->fcount & LPS25HFSS);
+    }
+    if (reg == PRESS_OUT_XL)
+    {
+        ShSimSlot(dev);
+    }
+    val = dev->reg[reg];
+    if (reg == LPS_TEMP_OUT_H && !ShSimFifoMean(dev) && dev->fcount > 0)
+    {
+        dev->fhead = (dev->fhead + 1) % LPS25HFIFOSZ;
+        dev->fcount--;
+    }
+    return val;
+}
+
+/** Maps a handle to its device model
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd handle returned by setup
+ * @return shsimdev_s * device, NULL for unknown handles
+ */
+static shsimdev_s * ShSimFromFd(int fd)
+{
+    if (fd == SHSIMHTSFD)
+    {
+        return &hts221;
+    }
+    if (fd == SHSIMLPSFD)
+    {
+        return &lps25h;
+    }
+    return NULL;
+}
+
+/** Decides whether the current transfer fails
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param dev device model
+ * @return int 1 if the transfer must return -1
+ */
+static int ShSimFails(shsimdev_s * dev)
+{
+    dev->transfers++;
+    // xorshift keeps fault sequences reproducible between runs
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    if (dev->fault.offline || (int) (seed % 1000) < dev->fault.errorpermille)
+    {
+        dev->errors++;
+        return 1;
+    }
+    return 0;
+}
+
+/** Simulated wiringPiI2CSetup
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param devId I2C address
+ * @return int handle, -1 if the device is offline or unknown
+ */
+static int ShSimSetup(int devId)
+{
+    if (hts221.reg[WHO_AM_I] == 0)
+    {
+        ShSimCalibrate();
+    }
+    if (devId == HTS221I2CADDRESS && !hts221.fault.offline)
+    {
+        return SHSIMHTSFD;
+    }
+    if (devId == LPS25HI2CADDRESS && !lps25h.fault.offline)
+    {
+        return SHSIMLPSFD;
+    }
+    return -1;
+}
+
+/** Simulated wiringPiI2CReadReg8
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd device handle
+ * @param reg register address
+ * @return int register value, -1 on an injected bus error
+ */
+static int ShSimRead8(int fd, int reg)
+{
+    shsimdev_s * dev = ShSimFromFd(fd);
+
+    if (dev == NULL || reg < 0 || reg >= SHSIMREGS || ShSimFails(dev))
+    {
+        return -1;
+    }
+    return ShSimReg(dev, reg);
+}
+
+/** Simulated SMBus I2C block read
+ * The LPS25H advances the register address while it is or'ed with
+ * LPS25HAUTOINC, wrapping from LPS_TEMP_OUT_H back to PRESS_OUT_XL when
+ * its FIFO is on so consecutive slots read in one transfer.
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd device handle
+ * @param reg first register address
+ * @param buf receives the bytes
+ * @param len bytes to read
+ * @return int len, -1 on an injected bus error
+ */
+static int ShSimReadBlock(int fd, int reg, uint8_t * buf, int len)
+{
+    shsimdev_s * dev = ShSimFromFd(fd);
+    int inc = reg & LPS25HAUTOINC;
+
+    reg &= ~LPS25HAUTOINC;
+    if (dev == NULL || reg < 0 || reg >= SHSIMREGS || len > SHBLOCKMAX || ShSimFails(dev))
+    {
+        return -1;
+    }
+    for (int i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t) ShSimReg(dev, reg);
+        if (inc && reg == LPS_TEMP_OUT_H && ShSimFifoOn(dev))
+        {
+            reg = PRESS_OUT_XL;
+        }
+        else if (inc)
+        {
+            reg = (reg + 1) % SHSIMREGS;
+        }
+    }
+    return len;
+}
+
+/** Simulated wiringPiI2CWriteReg8
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param fd device handle
+ * @param reg register address
+ * @param data value to write
+ * @return int 0, -1 on an injected bus error
+ */
+static int ShSimWrite8(int fd, int reg, int data)
+{
+    shsimdev_s * dev = ShSimFromFd(fd);
+
+    if (dev == NULL || reg < 0 || reg >= SHSIMREGS || ShSimFails(dev))
+    {
+        return -1;
+    }
+    // Samples due under the old settings are taken first
+    ShSimSample(dev);
+    dev->reg[reg] = data & 0xFF;
+    if (dev == &lps25h && ((reg == FIFO_CTRL && !(data & 0xE0)) || (reg == CTRL_REG1 && !(data & 0x80))))
+    {
+        // Bypass mode and power down empty the FIFO
+        dev->fhead = 0;
+        dev->fcount = 0;
+    }
+    ShSimSample(dev);
+    if (reg == CTRL_REG2 && (data & 0x01))
+    {
+        dev->busy = dev->fault.busypolls;
+    }
+    return 0;
+}
+
+/** Simulated delay, returns at once and accounts the requested time
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param usecs requested delay in microseconds
+ * @return void
+ */
+static void ShSimDelay(unsigned int usecs)
+{
+    delayed += usecs;
+}
+
+const shbus_s ShSimBus = { 0, ShSimSetup, ShSimRead8, ShSimWrite8, ShSimDelay, ShSimReadBlock };
+
+/** Sets the environment the simulated sensors will measure next
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param temperature degrees C
+ * @param humidity percent relative humidity
+ * @param pressure millibars
+ * @return void
+ */
+void ShSimSetValues(double temperature, double humidity, double pressure)
+{
+    simt = temperature;
+    simh = humidity;
+    simp = pressure;
+}
+
+/** Injects faults into one simulated device
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param address I2C address of the device
+ * @param fault fault description, zeroed for a healthy device
+ * @return void
+ */
+void ShSimSetFault(int address, shfault_s fault)
+{
+    shsimdev_s * dev = ShSimDevice(address);
+
+    if (dev != NULL)
+    {
+        dev->fault = fault;
+    }
+}
+
+/** Gets the model of one simulated device for inspection
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param address I2C address of the device
+ * @return shsimdev_s * device, NULL for unknown addresses
+ */
+shsimdev_s * ShSimDevice(int address)
+{
+    if (address == HTS221I2CADDRESS)
+    {
+        return &hts221;
+    }
+    if (address == LPS25HI2CADDRESS)
+    {
+        return &lps25h;
+    }
+    return NULL;
+}
+
+/** Gets the total time the sensor functions spent waiting on the bus
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param void
+ * @return long microseconds
+ */
+long ShSimDelayed(void)
+{
+    return delayed;
+}
+
+/** Sets the clock the LPS25H model samples by, on top of the delays
+ * @author Braydon Giallombardo
+ * @version 2026-10-19
+ * @param millis clock in milliseconds, NULL to count delays alone
+ * @return void
+ */
+void ShSimSetClock(long long (*millis)(void))
+{
+    simclock = millis;
+}
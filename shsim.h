@@ -0,0 +1,52 @@
+/** Simulated Sensehat I2C bus constants, structures, function prototypes
+ * @version shsim.h 2026-10-19
+ * @author Braydon Giallombardo
+ */
+#ifndef SHSIM_H
+#define SHSIM_H
+
+#include "pisensehat.h"
+
+// Constants
+#define SHSIMREGS 256
+#define SHSIMHTSFD 1000     // fake handles returned by setup
+#define SHSIMLPSFD 1001
+#define SHSIMPNOISE 0.03    // hPa rms noise of each simulated pressure sample
+#define SHSIMTNOISE 0.01    // C rms noise of each simulated temperature sample
+#define SHSIMHNOISE 0.05    // %rH rms noise of each simulated humidity sample
+
+// Structures
+typedef struct shfault
+{
+    int errorpermille;      // chance per transfer of returning -1
+    int busypolls;          // polls before the one-shot bit clears
+    int stuck;              // non zero keeps the one-shot bit set forever
+    int offline;            // non zero fails setup and every transfer
+} shfault_s;
+
+typedef struct shsimdev
+{
+    uint8_t reg[SHSIMREGS];
+    int busy;               // remaining polls of the running one-shot
+    shfault_s fault;
+    long transfers;
+    long errors;
+    int32_t fifop[LPS25HFIFOSZ];    // LPS25H FIFO slots, raw pressure
+    int16_t fifot[LPS25HFIFOSZ];    // and temperature
+    int fhead;                      // oldest slot
+    int fcount;
+    long long fnext;                // model time in us of the next sample, 0 while stopped
+    long samples;                   // samples the FIFO took
+    long lost;                      // samples overwritten before they were read
+} shsimdev_s;
+
+// Function Prototypes
+/// @cond INTERNAL
+extern const shbus_s ShSimBus;
+void ShSimSetValues(double temperature, double humidity, double pressure);
+void ShSimSetFault(int address, shfault_s fault);
+shsimdev_s * ShSimDevice(int address);
+long ShSimDelayed(void);
+void ShSimSetClock(long long (*millis)(void));
+/// @endcond
+#endif